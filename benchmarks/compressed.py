@@ -1,16 +1,10 @@
-from pathlib import Path
-import pandas as pd
 import matplotlib.pyplot as plt
 
-def plot_results(filename, algo_name=None):
-    # Load file
-    base_dir = Path("algo_results")
-    file = base_dir / filename
-    df = pd.read_csv(file)
+from dnaseq_bench import thread_sweep
 
-    # Auto-detect algorithm name from file if not given
-    if algo_name is None:
-        algo_name = filename.split("_")[0].upper()
+def plot_results(algo_name):
+    # Time the engine in-process on the reference genome
+    df = thread_sweep(algo_name)
 
     # Compute metrics
     df["Speedup"] = df["SerialTime"] / df["ParallelTime"]
@@ -57,10 +51,10 @@ def plot_results(filename, algo_name=None):
 
 # Example usage:
 # For BM results
-# plot_results("bm_results.csv", "BM")
+# plot_results("BM")
 
 # For BP results
-# plot_results("bp_results.csv", "BP")
+# plot_results("BP")
 
 # For KMP results
-plot_results("kmp_results.csv", "KMP")
+plot_results("KMP")
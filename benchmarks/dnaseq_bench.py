@@ -0,0 +1,105 @@
+"""
+dnaseq_bench.py
+
+Shared helpers for the benchmark scripts: loads the reference once and times
+the C++ engines in-process through the dnaseq module (build it with
+`cd src && make python`). The genome is handed to the engines as a buffer, so
+no run copies or re-reads the FASTA.
+"""
+
+import random
+import sys
+import time
+from pathlib import Path
+
+import pandas as pd
+
+REPO = Path(__file__).resolve().parent.parent
+sys.path.insert(0, str(REPO / "src" / "build"))
+import dnaseq  # noqa: E402
+
+# --------------- CONFIG ---------------
+FASTA = REPO / "dna" / "mycoplasmoides_genitalium.fasta"
+LENGTHS = [64, 128, 256, 512, 1000, 2000]
+THREADS = [1, 2, 4, 8]
+REPEATS = 3                    # best-of to damp scheduler noise
+RANDOM_SEED = 42
+# --------------------------------------
+
+# Short names used in file names and plot titles
+ENGINES = {
+    "BM": dnaseq.BoyerMooreHorspool,
+    "BP": dnaseq.BitParallelShiftOr,
+    "KMP": dnaseq.KMP,
+    "BNDM": dnaseq.BNDM,
+    "QBMH": dnaseq.QGramBMH,
+}
+MAX_LENGTH = {"BP": 64}        # shift-or packs the pattern into one 64-bit word
+
+_genomes = {}
+
+
+def load_genome(path=FASTA):
+    """Genome handle for path, loaded once per process."""
+    key = str(path)
+    if key not in _genomes:
+        _genomes[key] = dnaseq.Genome.load(key)
+    return _genomes[key]
+
+
+def best_ms(fn):
+    """Lowest wall time of REPEATS calls, in ms, and the last result."""
+    best, result = None, None
+    for _ in range(REPEATS):
+        t0 = time.perf_counter()
+        result = fn()
+        elapsed = (time.perf_counter() - t0) * 1000.0
+        best = elapsed if best is None else min(best, elapsed)
+    return best, result
+
+
+def sample_patterns(genome, lengths=LENGTHS, seed=RANDOM_SEED):
+    """One pattern per length, cut from the genome so it matches at least once."""
+    rng = random.Random(seed)
+    view = memoryview(genome)
+    patterns = {}
+    for length in lengths:
+        start = rng.randrange(0, len(genome) - length)
+        patterns[length] = bytes(view[start:start + length]).decode()
+    return patterns
+
+
+def thread_sweep(algo, lengths=LENGTHS, threads=THREADS, fasta=FASTA):
+    """
+    SerialTime / ParallelTime (ms) per pattern length and thread count.
+
+    Threads is the worker count the engine actually ran with: the calibration
+    profile (dnaseq.threads_for) may cap a request, so requests that collapse
+    to an already measured count are skipped.
+
+    Columns: PatternLength, Threads, RequestedThreads, SerialTime, ParallelTime, Matches
+    """
+    genome = load_genome(fasta)
+    engine = ENGINES[algo]()
+    rows = []
+    for length, pattern in sample_patterns(genome, lengths).items():
+        if length > MAX_LENGTH.get(algo, length):
+            continue
+        compiled = dnaseq.compile(pattern)
+        serial_time, matches = best_ms(lambda: engine.search(compiled, genome))
+        measured = set()
+        for t in threads:
+            effective = dnaseq.threads_for(engine.name, len(genome), t)
+            if effective in measured:
+                continue
+            measured.add(effective)
+            parallel_time, _ = best_ms(lambda: engine.search_parallel(compiled, genome, t))
+            rows.append({
+                "PatternLength": length,
+                "Threads": effective,
+                "RequestedThreads": t,
+                "SerialTime": serial_time,
+                "ParallelTime": parallel_time,
+                "Matches": matches,
+            })
+    return pd.DataFrame(rows)
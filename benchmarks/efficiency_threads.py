@@ -1,14 +1,11 @@
-import pandas as pd
 import matplotlib.pyplot as plt
-import os
 
-# Base folder for your results
-base_dir = "algo_results"
+from dnaseq_bench import thread_sweep
 
-# Pick file
-bm_file = os.path.join(base_dir, "bm_results.csv")
+# Pick engine (BM, BP, KMP, BNDM, QBMH); timed in-process on the reference genome
+algo = "BM"
 
-df = pd.read_csv(bm_file)
+df = thread_sweep(algo)
 
 # Compute efficiency
 df["Speedup"] = df["SerialTime"] / df["ParallelTime"]
@@ -21,7 +18,7 @@ for length in df["PatternLength"].unique():
 
 plt.xlabel("Number of Threads")
 plt.ylabel("Efficiency (%)")
-plt.title("BM: Efficiency vs Threads")
+plt.title(f"{algo}: Efficiency vs Threads")
 plt.legend()
 plt.grid(True)
 plt.show()
@@ -1,14 +1,11 @@
-import pandas as pd
 import matplotlib.pyplot as plt
-import os
 
-# Base folder for your results
-base_dir = "algo_results"
+from dnaseq_bench import thread_sweep
 
-# Pick file
-bm_file = os.path.join(base_dir, "bm_results.csv")
+# Pick engine (BM, BP, KMP, BNDM, QBMH); timed in-process on the reference genome
+algo = "BM"
 
-df = pd.read_csv(bm_file)
+df = thread_sweep(algo)
 
 plt.figure(figsize=(8,5))
 
@@ -22,7 +19,7 @@ plt.plot(parallel["PatternLength"], parallel["ParallelTime"], marker="s", linest
 
 plt.xlabel("Pattern Length")
 plt.ylabel("Execution Time (ms)")
-plt.title("BM: Execution Time vs Pattern Length")
+plt.title(f"{algo}: Execution Time vs Pattern Length")
 plt.legend()
 plt.grid(True)
 plt.show()
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+#include <vector>
+
+/**
+ * @brief Per-thread bump allocator for per-search scratch buffers
+ *
+ * Bad-char tables, LPS arrays and reverse-complemented patterns only live for
+ * the duration of one search call. They are carved out of a thread-local
+ * arena and released all at once when the enclosing Scope ends. Blocks are
+ * kept for reuse, so once a thread has seen its largest pattern the search
+ * path no longer touches the global heap.
+ */
+class Arena : public std::pmr::memory_resource {
+public:
+    /**
+     * @brief RAII mark: everything allocated while the scope is alive is
+     *        handed back to the arena when it is destroyed
+     */
+    class Scope {
+    public:
+        Scope();
+        explicit Scope(Arena& arena);
+        ~Scope();
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+        std::pmr::memory_resource* resource() const { return &arena; }
+
+    private:
+        Arena& arena;
+        size_t block;
+        size_t offset;
+    };
+
+    Arena() = default;
+    ~Arena() override;
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    /**
+     * @brief Arena owned by the calling thread
+     */
+    static Arena& local();
+
+    /**
+     * @brief Number of blocks requested from the global heap so far
+     */
+    size_t upstreamAllocations() const { return upstream_allocations; }
+
+    /**
+     * @brief Total bytes currently held by the arena
+     */
+    size_t bytesReserved() const;
+
+    /**
+     * @brief Returns every block to the global heap (no live Scope allowed)
+     */
+    void release();
+
+private:
+    struct Block {
+        std::byte* data;
+        size_t size;
+    };
+
+    static constexpr size_t MIN_BLOCK_SIZE = 1 << 16; // 64k
+    static constexpr size_t BLOCK_ALIGNMENT = 64;     // cache line
+
+    std::vector<Block> blocks;
+    size_t current = 0;
+    size_t offset = 0;
+    size_t upstream_allocations = 0;
+
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void*, size_t, size_t) override {}
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+};
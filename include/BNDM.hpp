@@ -0,0 +1,57 @@
+#pragma once
+
+#include "PatternMatcher.hpp"
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @brief Factor-based backward matcher
+ *
+ * Patterns of up to 64 bases use BNDM (Backward Nondeterministic DAWG
+ * Matching) with masks derived from the shift-or tables; longer patterns use
+ * Backward Oracle Matching over a factor oracle of the reversed pattern. Both
+ * read the window right to left and skip past any suffix that is not a factor
+ * of the pattern, which gives far longer shifts than a single-character
+ * bad-char table on a 4-letter alphabet.
+ */
+class BNDM : public PatternMatcher {
+public:
+    static constexpr size_t MAX_BNDM_LENGTH = 64;
+
+    /**
+     * @brief BNDM masks: bit (m - 1 - i) of D[c] is set when pattern[i] == c (m <= 64)
+     */
+    static void buildMasks(std::string_view pattern, uint64_t (&D)[256]);
+
+    /**
+     * @brief Oracle alphabet: code[c] in 1..sigma-1 for bytes of the pattern, 0 otherwise
+     * @return sigma, the row width of the oracle's transition table
+     */
+    static size_t buildOracleAlphabet(std::string_view pattern, uint8_t (&code)[256]);
+
+    /**
+     * @brief Factor oracle of the reversed pattern (m > 64)
+     * @param next Receives (m + 1) * sigma transitions, -1 = none
+     * @param supply Scratch for m + 1 supply links
+     */
+    static void buildOracle(std::string_view pattern, const uint8_t (&code)[256], size_t sigma,
+                            int32_t* next, int32_t* supply);
+
+    size_t search(std::string_view pattern, std::string_view text) const override;
+    std::string_view name() const override;
+    size_t searchInFasta(const std::string& pattern, const std::string& fastaPath) const override;
+    size_t searchParallel(std::string_view pattern, std::string_view text, int num_threads) const override;
+    size_t searchParallelInFasta(const std::string& pattern, const std::string& fastaPath) const override;
+    size_t searchWithReverseComplement(std::string_view pattern, std::string_view text, bool parallel) const override;
+    size_t searchRange(std::string_view pattern, std::string_view text, size_t begin, size_t end) const override;
+    void scanRange(std::string_view pattern, std::string_view text, size_t begin, size_t end, MatchSink& sink) const override;
+    size_t searchRange(const CompiledStrand& pattern, std::string_view text, size_t begin, size_t end) const override;
+    void scanRange(const CompiledStrand& pattern, std::string_view text, size_t begin, size_t end, MatchSink& sink) const override;
+
+    using PatternMatcher::search;
+    using PatternMatcher::searchParallel;
+    using PatternMatcher::searchWithReverseComplement;
+};
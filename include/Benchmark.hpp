@@ -15,4 +15,10 @@ class Benchmark {
     public:
         static void run(const std::string& pattern, const std::string& fastaPath);
 
+        /**
+         * @brief Times a full parallel scan with workers unpinned, on the node holding their
+         *        chunk, and on the node next to it
+         */
+        static void runPlacement(const std::string& pattern, const std::string& fastaPath, int num_threads = 4);
+
 };
\ No newline at end of file
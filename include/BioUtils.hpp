@@ -1,87 +1,138 @@
 #pragma once
 
 #include <string>
+#include <string_view>
+#include <memory_resource>
+#include <vector>
 #include <algorithm>
 #include <cmath>
 
 namespace BioUtils {
-    
-    inline std::string reverseComplement(const std::string& dna) {
-        std::string rc;
-        rc.reserve(dna.length());
-        
-        for (int i = dna.length() - 1; i >= 0; i--) {
-            switch (dna[i]) {
-                case 'A': rc += 'T'; break;
-                case 'T': rc += 'A'; break;
-                case 'G': rc += 'C'; break;
-                case 'C': rc += 'G'; break;
-                case 'a': rc += 't'; break;
-                case 't': rc += 'a'; break;
-                case 'g': rc += 'c'; break;
-                case 'c': rc += 'g'; break;
-                case 'N': rc += 'N'; break;
-                case 'n': rc += 'n'; break;
-                default:  rc += dna[i]; break;  // Handle other IUPAC codes
-            }
+
+    /**
+     * @brief Case-insensitive nucleotide tally of a sequence
+     */
+    struct BaseCounts {
+        size_t a = 0;
+        size_t c = 0;
+        size_t g = 0;
+        size_t t = 0;
+
+        size_t acgt() const { return a + c + g + t; }
+        size_t gc() const { return g + c; }
+
+        BaseCounts& operator+=(const BaseCounts& o) { a += o.a; c += o.c; g += o.g; t += o.t; return *this; }
+        BaseCounts& operator-=(const BaseCounts& o) { a -= o.a; c -= o.c; g -= o.g; t -= o.t; return *this; }
+    };
+
+    inline char complementBase(char c) {
+        switch (c) {
+            case 'A': return 'T';
+            case 'T': return 'A';
+            case 'G': return 'C';
+            case 'C': return 'G';
+            case 'a': return 't';
+            case 't': return 'a';
+            case 'g': return 'c';
+            case 'c': return 'g';
+            case 'N': return 'N';
+            case 'n': return 'n';
+            default:  return c;  // Handle other IUPAC codes
         }
+    }
+
+    /**
+     * @brief Counts A/C/G/T (either case) using AVX2 when available
+     */
+    BaseCounts countBases(std::string_view dna);
+
+    /**
+     * @brief Writes the reverse complement of src[0, n) into dst[0, n)
+     * @note src and dst must not overlap; large inputs are split across threads
+     */
+    void reverseComplementInto(const char* src, size_t n, char* dst);
+
+    /**
+     * @brief Reverse-complements a sequence without a second buffer
+     */
+    void reverseComplementInPlace(std::string& dna);
+
+    /**
+     * @brief Writes the upper-cased ASCII of src[0, n) into dst (may alias src)
+     */
+    void toUpperCaseInto(const char* src, size_t n, char* dst);
+
+    inline std::string reverseComplement(std::string_view dna) {
+        std::string rc(dna.size(), '\0');
+        reverseComplementInto(dna.data(), dna.size(), rc.data());
         return rc;
     }
-    
-    
-    inline double calculateShannonEntropy(const std::string& pattern) {
-        if (pattern.empty()) return 0.0;
-        
-        // Count each nucleotide (case insensitive)
-        int counts[256] = {0};
-        int total = 0;
-        
-        for (char c : pattern) {
-            char upper = std::toupper(c);
-            if (upper == 'A' || upper == 'T' || upper == 'G' || upper == 'C') {
-                counts[static_cast<unsigned char>(upper)]++;
-                total++;
-            }
-        }
-        
+
+    // Same as above, but the result lives in caller-provided memory (e.g. an Arena scope)
+    inline std::pmr::string reverseComplement(std::string_view dna, std::pmr::memory_resource* mr) {
+        std::pmr::string rc(dna.size(), '\0', mr);
+        reverseComplementInto(dna.data(), dna.size(), rc.data());
+        return rc;
+    }
+
+    inline double shannonEntropy(const BaseCounts& counts) {
+        const size_t total = counts.acgt();
         if (total == 0) return 0.0;
-        
-        // Calculate entropy
+
         double entropy = 0.0;
-        for (int i = 0; i < 256; i++) {
-            if (counts[i] > 0) {
-                double p = static_cast<double>(counts[i]) / total;
+        for (size_t n : {counts.a, counts.c, counts.g, counts.t}) {
+            if (n > 0) {
+                double p = static_cast<double>(n) / total;
                 entropy -= p * std::log2(p);
             }
         }
-        
         // Returns 0.0 (repetitive) to 2.0 (complex)
         return entropy;
     }
 
-    inline double calculateGCContent(const std::string& pattern) {
-        if (pattern.empty()) return 0.0;
-        
-        size_t gc_count = 0;
-        size_t total_bases = 0;
-        
-        for (char c : pattern) {
-            char upper = std::toupper(c);
-            if (upper == 'G' || upper == 'C') {
-                gc_count++;
-            }
-            if (upper == 'A' || upper == 'T' || upper == 'G' || upper == 'C') {
-                total_bases++;
-            }
-        }
-        
-        if (total_bases == 0) return 0.0;
-        return static_cast<double>(gc_count) / total_bases;
+    inline double gcContent(const BaseCounts& counts) {
+        const size_t total = counts.acgt();
+        if (total == 0) return 0.0;
+        return static_cast<double>(counts.gc()) / total;
+    }
+
+    inline double calculateShannonEntropy(std::string_view pattern) {
+        return shannonEntropy(countBases(pattern));
+    }
+
+    inline double calculateGCContent(std::string_view pattern) {
+        return gcContent(countBases(pattern));
     }
 
-    inline std::string toUpperCaseDNA(const std::string& dna) {
-        std::string result = dna;
-        std::transform(result.begin(), result.end(), result.begin(), ::toupper);
+    inline std::string toUpperCaseDNA(std::string_view dna) {
+        std::string result(dna.size(), '\0');
+        toUpperCaseInto(dna.data(), dna.size(), result.data());
         return result;
     }
-}
\ No newline at end of file
+
+    inline std::pmr::string toUpperCaseDNA(std::string_view dna, std::pmr::memory_resource* mr) {
+        std::pmr::string result(dna.size(), '\0', mr);
+        toUpperCaseInto(dna.data(), dna.size(), result.data());
+        return result;
+    }
+
+    inline void toUpperCaseDNAInPlace(std::string& dna) {
+        toUpperCaseInto(dna.data(), dna.size(), dna.data());
+    }
+
+    /**
+     * @brief Base counts of every full window [k*step, k*step + window) of a sequence
+     * @param num_threads Worker threads; each slides its own run of windows incrementally
+     */
+    std::vector<BaseCounts> windowedBaseCounts(std::string_view dna, size_t window, size_t step, int num_threads);
+
+    /**
+     * @brief GC fraction per window (see windowedBaseCounts for the window layout)
+     */
+    std::vector<double> windowedGCContent(std::string_view dna, size_t window, size_t step, int num_threads);
+
+    /**
+     * @brief Shannon entropy per window (see windowedBaseCounts for the window layout)
+     */
+    std::vector<double> windowedShannonEntropy(std::string_view dna, size_t window, size_t step, int num_threads);
+}
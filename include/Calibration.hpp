@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstddef>
+#include <map>
+#include <optional>
+#include <string>
+#include <string_view>
+
+/**
+ * @brief Host-measured thread counts and chunk sizes for the parallel matchers
+ *
+ * Every searchParallel used to drop to one thread below a fixed 64k bases per
+ * worker. A Profile replaces that constant with measurements taken on the host:
+ * each engine's single-thread scan rate, the bandwidth a full-width streaming
+ * read saturates at, and the cost of an empty fork/join. From those,
+ * threadsFor() picks how many workers a search of n bases gets.
+ *
+ * The profile is read once from DNASEQ_CALIBRATION (default
+ * $HOME/.cache/dnaseq_calibration.txt). A file measured on a host with a
+ * different CPU count is ignored. Set DNASEQ_CALIBRATE=1 to measure and save
+ * on first use when no valid file exists, or DNASEQ_CALIBRATE=force to always
+ * re-measure. Without a profile the old 64k-per-worker rule applies.
+ */
+namespace Calibration {
+
+    // Bases per worker when an engine has not been measured
+    static constexpr size_t DEFAULT_MIN_CHUNK = 1 << 16; // 64k
+
+    struct EngineRate {
+        double bytes_per_second = 0;  // single-thread scan rate
+        size_t min_chunk = DEFAULT_MIN_CHUNK;
+    };
+
+    struct Profile {
+        int hardware_threads = 0;       // 0 when not calibrated
+        double bandwidth = 0;           // saturated streaming read, bytes per second
+        double fork_join_seconds = 0;   // one empty parallel region at full width
+        std::map<std::string, EngineRate, std::less<>> engines;  // keyed by PatternMatcher::name()
+
+        bool calibrated() const { return hardware_threads > 0; }
+
+        /**
+         * @brief Workers for a scan of n bases by engine, never more than requested
+         * @note At least one; each worker gets minChunk(engine) bases or more,
+         *       and no more workers than it takes to saturate bandwidth
+         */
+        int threadsFor(std::string_view engine, size_t n, int requested) const;
+
+        size_t minChunk(std::string_view engine) const;
+    };
+
+    /**
+     * @brief Measures the host; text_bytes is the size of the scanned buffer
+     * @note Takes about a second at the default size; every engine is timed
+     *       on the same random text with a 32-base primer
+     */
+    Profile measure(size_t text_bytes = size_t{32} << 20);
+
+    /**
+     * @brief Writes a profile as text
+     * @return false if the file could not be written
+     */
+    bool save(const Profile& profile, const std::string& path);
+
+    /**
+     * @brief Reads a profile written by save, or nullopt if missing or malformed
+     */
+    std::optional<Profile> load(const std::string& path);
+
+    /**
+     * @brief DNASEQ_CALIBRATION, else $HOME/.cache/dnaseq_calibration.txt
+     */
+    std::string defaultPath();
+
+    /**
+     * @brief Profile in use; loaded (or measured) on first call
+     * @note The reference stays valid after setCurrent installs another profile
+     */
+    const Profile& current();
+    void setCurrent(Profile profile);
+
+    /**
+     * @brief current().threadsFor(engine, n, requested)
+     */
+    int threadsFor(std::string_view engine, size_t n, int requested);
+}
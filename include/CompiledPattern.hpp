@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @brief Every engine's preprocessing for one orientation of a pattern
+ *
+ * Per-byte tables come first, each starting on its own cache line and stored
+ * in the narrowest type that holds its values. Tables an engine cannot use for
+ * this length (shift-or and BNDM masks past 64 bases, the oracle up to 64) are
+ * left empty.
+ */
+struct alignas(64) CompiledStrand {
+    alignas(64) uint64_t shift_or[256];   // BitParallelShiftOr::buildMasks
+    alignas(64) uint64_t bndm[256];       // BNDM: bit (m - 1 - i) set when bases[i] == c
+    alignas(64) uint32_t bad_char[256];   // BoyerMooreHorspool shifts
+    alignas(64) uint8_t oracle_code[256]; // BOM alphabet codes, 0 = byte absent from the pattern
+    uint32_t oracle_sigma = 0;
+    uint32_t q = 0;                       // QGramBMH gram length, 0 = short-pattern fallback
+
+    std::string bases;
+    std::vector<uint32_t> lps;            // KMP failure function
+    std::vector<int32_t> oracle_next;     // BOM transitions, (m + 1) x oracle_sigma
+    std::vector<uint32_t> qgram_shift;    // QGramBMH shifts, 4^q + 2 entries
+
+    size_t size() const { return bases.size(); }
+};
+
+/**
+ * @brief A pattern preprocessed once for every engine and both strands
+ *
+ * Built by PatternMatcher::compile and never modified afterwards, so one
+ * instance can be shared read-only by any number of threads and searches.
+ * Passing it to the matchers' CompiledPattern overloads skips the per-call
+ * table building and reverse complement of the string_view entry points.
+ */
+class CompiledPattern {
+public:
+    static std::shared_ptr<const CompiledPattern> compile(std::string_view pattern);
+
+    const std::string& pattern() const { return fwd.bases; }
+    size_t size() const { return fwd.size(); }
+    const CompiledStrand& forward() const { return fwd; }
+    const CompiledStrand& reverse() const { return rev; }
+    // The reverse complement equals the pattern, so both strands hit the same places
+    bool palindrome() const { return fwd.bases == rev.bases; }
+
+    CompiledPattern(const CompiledPattern&) = delete;
+    CompiledPattern& operator=(const CompiledPattern&) = delete;
+
+private:
+    CompiledPattern() = default;
+    static void build(std::string_view bases, CompiledStrand& out);
+
+    CompiledStrand fwd;
+    CompiledStrand rev;
+};
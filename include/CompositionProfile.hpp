@@ -0,0 +1,58 @@
+#pragma once
+
+#include "BioUtils.hpp"
+
+#include <string_view>
+#include <vector>
+
+/**
+ * @brief Composition of one tile of the text
+ */
+struct RegionComposition {
+    size_t start = 0;
+    size_t length = 0;
+    BioUtils::BaseCounts counts;
+    double gc_content = 0.0;
+    double entropy = 0.0;
+    double homopolymer_density = 0.0; // fraction of positions equal to the previous base
+    double repeat_density = 0.0;      // max fraction of positions equal to the base 2, 3 or 4 back
+};
+
+/**
+ * @brief Per-window composition of a whole sequence, computed in one pass
+ *
+ * The text is tiled into consecutive windows (the last one may be shorter).
+ * Each window is profiled independently, so tiles are spread across threads
+ * and every statistic is a byte-compare + popcount loop.
+ */
+class CompositionProfile {
+public:
+    static constexpr size_t DEFAULT_WINDOW = 1 << 16; // 64k
+
+    static CompositionProfile compute(std::string_view text, size_t window = DEFAULT_WINDOW, int num_threads = 4);
+
+    /**
+     * @brief Profiles a single region with the same statistics as a tile
+     */
+    static RegionComposition profileRegion(std::string_view text, size_t start, size_t length);
+
+    size_t windowSize() const { return window; }
+    size_t textLength() const { return text_length; }
+    const std::vector<RegionComposition>& windows() const { return tiles; }
+
+    /**
+     * @brief Tile containing text position pos
+     * @note Positions past the end map to the last tile; an empty profile returns an empty region
+     */
+    const RegionComposition& at(size_t pos) const;
+
+    /**
+     * @brief Length-weighted aggregate of the tiles overlapping [begin, end)
+     */
+    RegionComposition summarize(size_t begin, size_t end) const;
+
+private:
+    size_t window = DEFAULT_WINDOW;
+    size_t text_length = 0;
+    std::vector<RegionComposition> tiles;
+};
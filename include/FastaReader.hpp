@@ -1,7 +1,33 @@
 #pragma once
+#include "GenomeCache.hpp"
+
 #include <string>
+#include <vector>
 
 class FastaReader {
 public:
+    /**
+     * @brief All records concatenated, upper-cased, A/C/G/T/N only
+     * @note Served from the binary cache next to the file when it is current;
+     *       otherwise parsed and the cache written for the next run
+     */
     static std::string readSequence(const std::string& fastaPath);
-};
\ No newline at end of file
+
+    /**
+     * @brief Parses the FASTA text itself, bypassing the cache
+     * @param records If non-null, receives each record's name and span
+     */
+    static std::string parseSequence(const std::string& fastaPath, std::vector<GenomeCache::Record>* records = nullptr);
+
+    /**
+     * @brief Bases [begin, end) of readSequence(), without holding the rest in memory
+     * @note Decodes just that range from a current binary cache; otherwise streams
+     *       the FASTA text and keeps only the requested bases
+     */
+    static std::string readRange(const std::string& fastaPath, size_t begin, size_t end);
+
+    /**
+     * @brief Length of readSequence(), from the cache header or a streaming count
+     */
+    static size_t sequenceLength(const std::string& fastaPath);
+};
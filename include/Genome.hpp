@@ -0,0 +1,70 @@
+#pragma once
+
+#include "CompositionProfile.hpp"
+#include "MinimizerIndex.hpp"
+#include "SequenceBuffer.hpp"
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+/**
+ * @brief A loaded reference sequence plus the derived data cached with it
+ */
+class Genome {
+public:
+    // Thread count the matchers' *InFasta entry points use
+    static constexpr int DEFAULT_THREADS = 4;
+
+    /**
+     * @brief Copies the sequence into a SequenceBuffer placed for num_threads workers
+     */
+    explicit Genome(std::string_view sequence, std::string source = "", int num_threads = DEFAULT_THREADS);
+
+    /**
+     * @brief Takes ownership of already placed bases
+     */
+    Genome(SequenceBuffer buffer, std::string source);
+
+    /**
+     * @brief Reads a FASTA file, unpacking its binary cache straight into place when current
+     * @note Falls back to FastaReader (which writes the cache for the next run)
+     * @param num_threads Worker count the sequence pages are placed for; search with the same count
+     */
+    static std::shared_ptr<const Genome> load(const std::string& fastaPath, int num_threads = DEFAULT_THREADS);
+
+    std::string_view view() const { return seq.view(); }
+    const SequenceBuffer& buffer() const { return seq; }
+    const std::string& source() const { return src; }
+    size_t size() const { return seq.size(); }
+
+    /**
+     * @brief Composition profile for the given tile size, computed on first use
+     * @note Safe to call from several threads; the profile is built once
+     */
+    const CompositionProfile& profile(size_t window = CompositionProfile::DEFAULT_WINDOW) const;
+
+    /**
+     * @brief Minimizer index of the sequence, built on first use
+     * @note Reuses <source>.midx when it was built from this sequence; otherwise
+     *       builds in parallel and tries to write that file for the next run
+     */
+    const MinimizerIndex& minimizerIndex() const;
+
+    /**
+     * @brief Where minimizerIndex() caches the index for a FASTA file
+     */
+    static std::string indexPath(const std::string& fastaPath) { return fastaPath + ".midx"; }
+
+private:
+    SequenceBuffer seq;
+    std::string src;
+
+    mutable std::mutex profile_mutex;
+    mutable std::map<size_t, std::unique_ptr<CompositionProfile>> profiles;
+
+    mutable std::mutex index_mutex;
+    mutable std::unique_ptr<MinimizerIndex> index;
+};
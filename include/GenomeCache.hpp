@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @brief Binary cache of a parsed FASTA file, written next to it on first use
+ *
+ * .2bit-style layout: header, source path, record table, record names,
+ * N-run table, then the bases packed 2 bits each (A, C, G, T; N stored as A
+ * and restored from the run table). Coordinates are those of
+ * FastaReader::readSequence, i.e. all records concatenated. The file is
+ * mmap'd read-only and trusted only while the FASTA's path, size and mtime
+ * still match the header.
+ */
+class GenomeCache {
+public:
+    struct Record {
+        std::string name;     // header line without '>'
+        uint64_t offset = 0;  // first base in the concatenated sequence
+        uint64_t length = 0;
+    };
+
+    GenomeCache() = default;
+    ~GenomeCache();
+    GenomeCache(const GenomeCache&) = delete;
+    GenomeCache& operator=(const GenomeCache&) = delete;
+    GenomeCache(GenomeCache&& other) noexcept;
+    GenomeCache& operator=(GenomeCache&& other) noexcept;
+
+    /**
+     * @brief Where the cache for a FASTA file lives
+     */
+    static std::string cachePath(const std::string& fastaPath) { return fastaPath + ".dnabin"; }
+
+    /**
+     * @brief Writes the cache for sequence/records parsed from fastaPath
+     * @return false if the file could not be written (read-only directory, ...)
+     * @note Written to a temporary file and renamed, so readers never see a partial cache
+     */
+    static bool write(const std::string& fastaPath, std::string_view sequence, const std::vector<Record>& records);
+
+    /**
+     * @brief Maps the cache of fastaPath if it exists and still describes that file
+     */
+    static std::optional<GenomeCache> open(const std::string& fastaPath);
+
+    size_t size() const { return total_bases; }
+    std::vector<Record> records() const;
+
+    /**
+     * @brief Unpacks bases [begin, end) into out[0, end - begin)
+     */
+    void decode(char* out, size_t begin, size_t end) const;
+
+private:
+    void* mapping = nullptr;
+    size_t mapping_size = 0;
+    size_t total_bases = 0;
+    size_t record_count = 0;
+
+    const unsigned char* packed = nullptr;
+    const uint64_t* n_runs = nullptr;  // (start, length) pairs
+    size_t n_run_count = 0;
+    const char* record_table = nullptr;
+    const char* names = nullptr;
+};
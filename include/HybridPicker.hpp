@@ -4,19 +4,58 @@
 #include "BM.hpp"
 #include "KMP.hpp"
 #include "BP.hpp"
+#include "BNDM.hpp"
+#include "QGramBMH.hpp"
+#include "CompositionProfile.hpp"
+#include "ResultCache.hpp"
+#include <cstdint>
 #include <memory>
 #include <vector>
 #include <string>
+#include <string_view>
 #include <stdexcept>
 
+/**
+ * @brief Knobs for HybridPicker::estimateCount
+ *
+ * Sampling always covers at least sample_fraction of the chunks. Setting
+ * target_relative_error and/or time_budget_ms keeps adding rounds until the
+ * interval is narrow enough or the budget is spent, whichever comes first.
+ */
+struct EstimateOptions {
+    size_t chunk_size = 1 << 16;        // 64k bases per sampled unit
+    double sample_fraction = 0.02;      // chunks scanned before any stopping rule applies
+    double target_relative_error = 0.0; // stop once half-width / estimate <= this; 0 = off
+    double time_budget_ms = 0.0;        // stop adding rounds after this long; 0 = off
+    double z = 1.96;                    // normal quantile of the interval (1.96 = 95%)
+    uint64_t seed = 0;                  // 0 = seed from std::random_device
+    int num_threads = 4;
+};
+
+struct CountEstimate {
+    double count = 0;           // extrapolated total
+    double low = 0;             // interval bounds, clamped at 0
+    double high = 0;
+    double relative_error = 0;  // half-width / count (0 when exact)
+    size_t chunks_sampled = 0;
+    size_t chunks_total = 0;
+    bool exact = false;         // every chunk was scanned
+};
+
 class HybridPicker {
 private:
-    std::unique_ptr<PatternMatcher> createMatcher(const std::string& algorithmName);
+    ResultCache results;
     
 public:
+    /**
+     * @brief Engine for an algorithm name as returned by recommendAlgorithm
+     * @return nullptr if algorithmName is unknown
+     */
+    std::unique_ptr<PatternMatcher> createMatcher(const std::string& algorithmName);
+
     /**
      * @brief Selects and executes the appropriate pattern matching algorithm
-     * @param algorithmName Name of the algorithm: "bmh", "kmp", or "bithiftor"
+     * @param algorithmName Name of the algorithm: "bmh", "kmp", "bithiftor", "bndm" or "qbmh"
      * @param pattern The DNA pattern to search for
      * @param fastaPath Path to the FASTA file containing the DNA sequence
      * @return Vector of positions where the pattern was found
@@ -36,7 +75,7 @@ public:
                                          const std::string& fastaPath);
         /**
      * @brief Selects and executes the appropriate pattern matching algorithm
-     * @param algorithmName Name of the algorithm: "bmh", "kmp", or "bithiftor"
+     * @param algorithmName Name of the algorithm: "bmh", "kmp", "bithiftor", "bndm" or "qbmh"
      * @param pattern The DNA pattern to search for
      * @param fastaPath Path to the FASTA file containing the DNA sequence
      * @return Vector of positions where the pattern was found
@@ -54,11 +93,87 @@ public:
      */
    size_t autoPickAndSearchParallel(const std::string& pattern, 
                                          const std::string& fastaPath);
-                                         /**
+
+    /**
+     * @brief Region-adaptive parallel search: picks an engine per chunk of the text
+     * @param pattern The DNA pattern to search for
+     * @param fastaPath Path to the FASTA file containing the DNA sequence
+     * @return Number of matches
+     */
+    size_t autoPickAndSearchAdaptive(const std::string& pattern,
+                                     const std::string& fastaPath);
+
+    /**
+     * @brief Long-pattern search through the reference's minimizer index
+     * @param pattern The DNA pattern to search for
+     * @param fastaPath Path to the FASTA file; the index is cached next to it (see Genome::minimizerIndex)
+     * @return Number of matches
+     * @note Patterns the index cannot answer (short or without a clean k-mer window) fall back to a parallel scan
+     */
+    size_t autoPickAndSearchIndexed(const std::string& pattern,
+                                    const std::string& fastaPath);
+
+    /**
+     * @brief Query with a result cache shared by a pattern and its reverse complement
+     * @param pattern The DNA pattern to search for
+     * @param fastaPath Path to the FASTA file; a changed file (size or mtime) invalidates its entries
+     * @param q Count, exists, first or first-N
+     * @param bothStrands Also report the reverse complement's matches (counts add, positions merge)
+     * @return Result served from the cache when the pattern or its reverse complement was queried before
+     * @note Safe to call from several threads; a miss scans both strands so a later flipped query hits
+     */
+    QueryResult searchCached(const std::string& pattern,
+                             const std::string& fastaPath,
+                             const Query& q = Query::count(),
+                             bool bothStrands = false);
+
+    ResultCache& resultCache() { return results; }
+
+    /**
+     * @brief Estimates the match count from a stratified random sample of chunks
+     * @param pattern The DNA pattern to search for
+     * @param text Sequence to estimate over
+     * @param opts Chunk size, minimum sample, optional error target / time budget
+     * @return Estimate with a normal-approximation confidence interval
+     * @note The text is cut into equal strata of consecutive chunks and every round
+     *       scans one more random chunk per stratum, in parallel. With no hit in the
+     *       sample the upper bound is the Poisson bound at the tail opts.z leaves
+     *       (the rule of three for z = 1.96).
+     */
+    CountEstimate estimateCount(const std::string& pattern,
+                                std::string_view text,
+                                const EstimateOptions& opts = {});
+
+    /**
+     * @brief Same as above on a FASTA file, decoding only the sampled chunks
+     * @note Reads them from the binary cache, which one parse writes if it is missing
+     */
+    CountEstimate estimateCountInFasta(const std::string& pattern,
+                                       const std::string& fastaPath,
+                                       const EstimateOptions& opts = {});
+
+    /**
      * @brief Recommends appropriate algorithm based on conditions
      * @return String of the name of the algorithm
      */
     std::string recommendAlgorithm(const std::string& pattern);
+
+    /**
+     * @brief Recommends an algorithm for one region of the text
+     * @param pattern The DNA pattern to search for
+     * @param region Composition of the text the pattern will be scanned against
+     * @return String of the name of the algorithm
+     */
+    std::string recommendAlgorithm(const std::string& pattern, const RegionComposition& region);
+
+    /**
+     * @brief Recommends an algorithm for every tile of a composition profile
+     * @param pattern The DNA pattern to search for
+     * @param profile Profile of the text (see Genome::profile)
+     * @return One algorithm name per profile window
+     */
+    std::vector<std::string> recommendAlgorithmsByRegion(const std::string& pattern,
+                                                         const CompositionProfile& profile);
     
     /**
      * @brief Gets list of available algorithms
@@ -0,0 +1,82 @@
+#pragma once
+
+#include "PatternMatcher.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @brief Keeps a pattern's matches current while the reference is edited
+ *
+ * The sequence is cut into chunks that each own the matches starting inside
+ * them (the same ownership rule the parallel engines use), and the hits of
+ * every chunk are kept relative to its start. An edit only rescans the chunks
+ * whose owned matches can read the changed bases: the edited chunks plus the
+ * m - 1 bases before them. Chunks after the edit keep their hits unchanged,
+ * since relative positions survive a shift.
+ */
+class IncrementalSearch {
+public:
+    static constexpr size_t DEFAULT_CHUNK = 1 << 20; // 1M
+
+    /**
+     * @param matcher Engine used for every chunk scan; KMP when null
+     * @param chunk_size Upper bound on a chunk's length; smaller chunks mean cheaper edits but more summaries
+     */
+    IncrementalSearch(std::string pattern, std::string_view text,
+                      std::unique_ptr<PatternMatcher> matcher = nullptr,
+                      int num_threads = 4, size_t chunk_size = DEFAULT_CHUNK);
+
+    /**
+     * @brief Appends bases (a new contig) and rescans only the tail
+     */
+    void append(std::string_view bases);
+
+    /**
+     * @brief Replaces [pos, pos + len) with bases, like std::string::replace
+     * @throws std::out_of_range if pos > size()
+     */
+    void replace(size_t pos, size_t len, std::string_view bases);
+
+    size_t count() const { return total; }
+    std::vector<size_t> positions() const;
+    QueryResult result(const Query& q = Query::count()) const;
+
+    std::string_view text() const { return seq; }
+    const std::string& pattern() const { return pat; }
+    size_t size() const { return seq.size(); }
+    size_t chunkCount() const { return chunks.size(); }
+
+    /**
+     * @brief Bases the last update rescanned (the whole text for the initial scan)
+     */
+    size_t lastRescanned() const { return rescanned; }
+
+private:
+    struct Chunk {
+        size_t length = 0;
+        std::vector<uint32_t> hits;  // match starts, relative to the chunk start
+    };
+
+    // Appends chunks of at most chunk_size covering length bases
+    void splitInto(std::vector<Chunk>& out, size_t length) const;
+    size_t chunkOf(size_t pos) const;
+    void rebuildStarts();
+    // Rescans chunks [first, last) and refreshes the total
+    void rescan(size_t first, size_t last);
+
+    std::string pat;
+    std::string seq;
+    std::unique_ptr<PatternMatcher> matcher;
+    std::shared_ptr<const CompiledPattern> compiled;  // tables shared by every chunk rescan
+    int num_threads;
+    size_t chunk_size;
+
+    std::vector<Chunk> chunks;
+    std::vector<size_t> starts;  // chunk offsets, plus size() at the end
+    size_t total = 0;
+    size_t rescanned = 0;
+};
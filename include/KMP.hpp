@@ -2,17 +2,32 @@
 
 #include "PatternMatcher.hpp"
 
+#include <cstdint>
+#include <memory_resource>
 #include <string>
+#include <string_view>
 #include <vector>
 
 class KMP : public PatternMatcher {
-private:
-    std::vector<size_t> computeLPS(const std::string& pattern) const;
-    
 public:
-    size_t search(const std::string& pattern, const std::string& text) const override;
+    /**
+     * @brief Failure function: lps[i] is the longest proper border of pattern[0, i]
+     * @param lps Receives pattern.size() entries
+     */
+    static void buildLPS(std::string_view pattern, uint32_t* lps);
+
+    size_t search(std::string_view pattern, std::string_view text) const override;
+    std::string_view name() const override;
     size_t searchInFasta(const std::string& pattern, const std::string& fastaPath) const override;
-    size_t searchParallel(const std::string& pattern, const std::string& text, int num_threads) const override;
+    size_t searchParallel(std::string_view pattern, std::string_view text, int num_threads) const override;
     size_t searchParallelInFasta(const std::string& pattern, const std::string& fastaPath) const override;
-    size_t searchWithReverseComplement(const std::string& pattern, const std::string& text, bool parallel) const override;
+    size_t searchWithReverseComplement(std::string_view pattern, std::string_view text, bool parallel) const override;
+    size_t searchRange(std::string_view pattern, std::string_view text, size_t begin, size_t end) const override;
+    void scanRange(std::string_view pattern, std::string_view text, size_t begin, size_t end, MatchSink& sink) const override;
+    size_t searchRange(const CompiledStrand& pattern, std::string_view text, size_t begin, size_t end) const override;
+    void scanRange(const CompiledStrand& pattern, std::string_view text, size_t begin, size_t end, MatchSink& sink) const override;
+
+    using PatternMatcher::search;
+    using PatternMatcher::searchParallel;
+    using PatternMatcher::searchWithReverseComplement;
 };
\ No newline at end of file
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @brief (w, k)-minimizer index of a reference for long-pattern lookup
+ *
+ * Every window of w consecutive k-mers contributes its smallest k-mer (by a
+ * hash order) and that k-mer's position. A window's minimizer depends only on
+ * the window's bases, so any occurrence of a pattern at text position s
+ * contains each of the pattern's own window minimizers at s + offset. A query
+ * therefore reads one seed's position list, verifies those few loci, and never
+ * scans the rest of the genome.
+ *
+ * Layout: open-addressing table of (k-mer, offset, count) slots plus one CSR
+ * array of uint32 positions, both flat so a saved index can be mmap'd as is.
+ */
+class MinimizerIndex {
+public:
+    static constexpr unsigned DEFAULT_K = 15;
+    static constexpr unsigned DEFAULT_W = 10;
+    static constexpr size_t MAX_TEXT = UINT32_MAX;
+
+    struct Slot {
+        uint64_t key;     // 2-bit packed k-mer, EMPTY_KEY when unused
+        uint32_t offset;  // first position in the CSR array
+        uint32_t count;   // number of positions
+    };
+    static constexpr uint64_t EMPTY_KEY = ~0ULL;
+
+    MinimizerIndex() = default;
+    ~MinimizerIndex();
+    MinimizerIndex(const MinimizerIndex&) = delete;
+    MinimizerIndex& operator=(const MinimizerIndex&) = delete;
+    MinimizerIndex(MinimizerIndex&& other) noexcept;
+    MinimizerIndex& operator=(MinimizerIndex&& other) noexcept;
+
+    /**
+     * @brief Builds the index in parallel
+     * @throws std::invalid_argument if k or w is out of range
+     * @throws std::length_error if the text is longer than MAX_TEXT
+     */
+    static MinimizerIndex build(std::string_view text, unsigned k = DEFAULT_K, unsigned w = DEFAULT_W,
+                                int num_threads = 4);
+
+    /**
+     * @brief Writes the index to a file that load() can map directly
+     * @throws std::runtime_error on I/O failure
+     */
+    void save(const std::string& path) const;
+
+    /**
+     * @brief Maps a saved index read-only
+     * @throws std::runtime_error if the file is missing, truncated, of another version or corrupt
+     * @note Reads the whole file once to check its hash and that every slot stays in bounds
+     */
+    static MinimizerIndex load(const std::string& path);
+
+    /**
+     * @brief True if the index was built from exactly this text
+     * @note Compares a hash of every byte, so it reads the whole text once
+     */
+    bool matches(std::string_view text) const;
+
+    /**
+     * @brief Shortest pattern that contains a full minimizer window
+     */
+    size_t minPatternLength() const { return k + w - 1; }
+
+    /**
+     * @brief Whether the index can answer this pattern on its own (long enough and
+     *        holding at least one window of A/C/G/T k-mers)
+     */
+    bool canAnswer(std::string_view pattern) const;
+
+    /**
+     * @brief Start positions of the pattern in text, ascending
+     * @note Requires canAnswer(pattern) and matches(text)
+     */
+    std::vector<size_t> find(std::string_view pattern, std::string_view text) const;
+
+    size_t count(std::string_view pattern, std::string_view text) const { return find(pattern, text).size(); }
+
+    unsigned kmerLength() const { return k; }
+    unsigned windowLength() const { return w; }
+    size_t textLength() const { return text_length; }
+    size_t seedCount() const { return positions_size; }
+
+private:
+    unsigned k = DEFAULT_K;
+    unsigned w = DEFAULT_W;
+    size_t text_length = 0;
+    uint64_t text_hash = 0;
+
+    const Slot* table = nullptr;
+    size_t table_size = 0;  // power of two
+    const uint32_t* positions = nullptr;
+    size_t positions_size = 0;
+
+    // Owned storage after build(); mapped file after load()
+    std::vector<Slot> table_storage;
+    std::vector<uint32_t> positions_storage;
+    void* mapping = nullptr;
+    size_t mapping_size = 0;
+
+    const Slot* lookup(uint64_t key) const;
+    void reset();
+};
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+/**
+ * @brief Thread-to-chunk placement for the parallel matchers
+ *
+ * Parallel paths split the text into num_threads equal chunks. Pinning worker
+ * tid to the same CPU when the genome buffer is first touched and again when
+ * chunk tid is scanned keeps every chunk on the NUMA node that reads it.
+ * CPUs are taken from the process affinity mask, grouped by node (sysfs), and
+ * handed out evenly, so consecutive chunks share a node.
+ */
+namespace Numa {
+
+    enum class Binding {
+        Off,     // leave scheduling to the OS
+        Local,   // worker tid runs on the node that holds chunk tid
+        Remote   // worker tid runs on the next node over (benchmark baseline only)
+    };
+
+    /**
+     * @brief Current policy; defaults to Local on multi-node hosts and Off otherwise,
+     *        overridable with DNASEQ_NUMA_BINDING=off|local|remote
+     */
+    Binding binding();
+    void setBinding(Binding b);
+    std::string bindingName(Binding b);
+
+    int nodeCount();
+
+    /**
+     * @brief Usable CPUs ordered by node
+     */
+    const std::vector<int>& cpus();
+
+    /**
+     * @brief CPU that owns chunk tid of num_threads under the Local policy
+     */
+    int localCpu(int tid, int num_threads);
+
+    /**
+     * @brief Pins the calling worker for chunk tid according to binding()
+     * @note Called at the top of every parallel region that walks the chunk layout;
+     *       a no-op when binding is Off or the thread already sits on that CPU. The
+     *       calling thread (team member 0) is never pinned, so chunk 0 runs wherever
+     *       the caller runs and the caller's affinity survives the region.
+     */
+    void bindWorker(int tid, int num_threads);
+
+    /**
+     * @brief Same as bindWorker with an explicit policy (first touch always uses Local)
+     * @note With Off, a thread pinned earlier gets back the affinity it had before its first pin
+     */
+    void bindWorker(int tid, int num_threads, Binding b);
+
+    /**
+     * @brief Unpins the calling thread and every OpenMP worker pinned so far
+     * @note Call after switching the policy back from Local/Remote (see Benchmark::runPlacement)
+     */
+    void restoreAffinity();
+}
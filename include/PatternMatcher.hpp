@@ -1,14 +1,93 @@
 #pragma once
 
+#include "CompiledPattern.hpp"
+
+#include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
 
+/**
+ * @brief What a query needs back: a full count, or an early answer
+ */
+enum class QueryMode {
+    Count,   // every match, count only
+    Exists,  // stop at the first match found anywhere
+    First,   // lowest match position
+    Limit    // lowest `limit` match positions
+};
+
+struct Query {
+    QueryMode mode = QueryMode::Count;
+    size_t limit = 0;  // Limit mode only
+
+    static Query count() { return {QueryMode::Count, 0}; }
+    static Query exists() { return {QueryMode::Exists, 1}; }
+    static Query first() { return {QueryMode::First, 1}; }
+    static Query firstN(size_t n) { return {QueryMode::Limit, n}; }
+};
+
+struct QueryResult {
+    size_t count = 0;               // matches reported (all of them in Count mode)
+    std::vector<size_t> positions;  // ascending; empty in Count mode
+    bool found() const { return count != 0; }
+};
+
+/**
+ * @brief Receiver for PatternMatcher::scanRange
+ */
+class MatchSink {
+public:
+    // Bases scanned between two keepScanning() polls
+    static constexpr size_t POLL_INTERVAL = 1 << 16; // 64k
+
+    virtual ~MatchSink() = default;
+    // Called for each match, in ascending order; false stops the scan
+    virtual bool onMatch(size_t pos) = 0;
+    // Polled once per block; false abandons the scan (another thread already has the answer)
+    virtual bool keepScanning() { return true; }
+};
+
 class PatternMatcher {
 public:
     virtual ~PatternMatcher() = default;
-    virtual size_t search(const std::string& pattern, const std::string& text) const = 0;
+    // Engine name as accepted by HybridPicker::createMatcher; keys the calibration profile
+    virtual std::string_view name() const = 0;
+    virtual size_t search(std::string_view pattern, std::string_view text) const = 0;
     virtual size_t searchInFasta(const std::string& pattern, const std::string& fastaPath) const = 0;
-    virtual size_t searchParallel(const std::string& pattern, const std::string& text, int num_threads) const = 0;
+    virtual size_t searchParallel(std::string_view pattern, std::string_view text, int num_threads) const = 0;
     virtual size_t searchParallelInFasta(const std::string& pattern, const std::string& fastaPath) const = 0;
-    virtual size_t searchWithReverseComplement(const std::string& pattern, const std::string& text, bool parallel) const = 0;   
-};
\ No newline at end of file
+    virtual size_t searchWithReverseComplement(std::string_view pattern, std::string_view text, bool parallel) const = 0;   
+    // Counts matches starting in [begin, end); reads text up to end + m - 1
+    virtual size_t searchRange(std::string_view pattern, std::string_view text, size_t begin, size_t end) const = 0;
+    // Reports matches starting in [begin, end) to sink, same reads as searchRange
+    virtual void scanRange(std::string_view pattern, std::string_view text, size_t begin, size_t end, MatchSink& sink) const = 0;
+    // Same as the two above for one strand of a compiled pattern, without building any table
+    virtual size_t searchRange(const CompiledStrand& pattern, std::string_view text, size_t begin, size_t end) const = 0;
+    virtual void scanRange(const CompiledStrand& pattern, std::string_view text, size_t begin, size_t end, MatchSink& sink) const = 0;
+
+    /**
+     * @brief Preprocesses a pattern once for every engine and both strands
+     * @note The result is immutable; share it across threads, records and files
+     */
+    static std::shared_ptr<const CompiledPattern> compile(std::string_view pattern);
+
+    // CompiledPattern overloads of the entry points; engines re-export them with using-declarations
+    size_t search(const CompiledPattern& pattern, std::string_view text) const;
+    size_t searchParallel(const CompiledPattern& pattern, std::string_view text, int num_threads) const;
+    size_t searchWithReverseComplement(const CompiledPattern& pattern, std::string_view text, bool parallel) const;
+
+    /**
+     * @brief Runs a query, stopping as soon as its mode is answered
+     */
+    QueryResult query(std::string_view pattern, std::string_view text, const Query& q) const;
+
+    /**
+     * @brief Parallel query: workers cancel each other once the answer is known
+     * @note First / Limit still return the globally lowest positions
+     */
+    QueryResult queryParallel(std::string_view pattern, std::string_view text, const Query& q, int num_threads) const;
+
+    QueryResult query(const CompiledPattern& pattern, std::string_view text, const Query& q) const;
+    QueryResult queryParallel(const CompiledPattern& pattern, std::string_view text, const Query& q, int num_threads) const;
+};
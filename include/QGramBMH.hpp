@@ -0,0 +1,53 @@
+#pragma once
+
+#include "PatternMatcher.hpp"
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @brief Boyer-Moore-Horspool with shifts keyed on the last q bases
+ *
+ * A single DNA character occurs near the end of almost any pattern, so the
+ * classic bad-char shift stays tiny. Hashing the window's last q bases (2 bits
+ * each, 4^q buckets) makes a repeat of that q-gram in the pattern rare, and the
+ * average shift grows towards m - q + 1. q is picked from the pattern length.
+ */
+class QGramBMH : public PatternMatcher {
+public:
+    static constexpr size_t MIN_Q = 2;
+    static constexpr size_t MAX_Q = 8;
+
+    /**
+     * @brief q used for a pattern of length m (0 when m is too short for q-grams)
+     */
+    static size_t chooseQ(size_t m);
+
+    /**
+     * @brief Entries of the shift table for gram length q: 4^q buckets, one for
+     *        grams holding a non-ACGT byte, and the slide after a verification
+     */
+    static size_t shiftTableSize(size_t q) { return (size_t{1} << (2 * q)) + 2; }
+
+    /**
+     * @brief Fills shiftTableSize(q) shifts for the pattern's q-grams
+     */
+    static void buildShiftTable(std::string_view pattern, size_t q, uint32_t* table);
+
+    size_t search(std::string_view pattern, std::string_view text) const override;
+    std::string_view name() const override;
+    size_t searchInFasta(const std::string& pattern, const std::string& fastaPath) const override;
+    size_t searchParallel(std::string_view pattern, std::string_view text, int num_threads) const override;
+    size_t searchParallelInFasta(const std::string& pattern, const std::string& fastaPath) const override;
+    size_t searchWithReverseComplement(std::string_view pattern, std::string_view text, bool parallel) const override;
+    size_t searchRange(std::string_view pattern, std::string_view text, size_t begin, size_t end) const override;
+    void scanRange(std::string_view pattern, std::string_view text, size_t begin, size_t end, MatchSink& sink) const override;
+    size_t searchRange(const CompiledStrand& pattern, std::string_view text, size_t begin, size_t end) const override;
+    void scanRange(const CompiledStrand& pattern, std::string_view text, size_t begin, size_t end, MatchSink& sink) const override;
+
+    using PatternMatcher::search;
+    using PatternMatcher::searchParallel;
+    using PatternMatcher::searchWithReverseComplement;
+};
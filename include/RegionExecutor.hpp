@@ -0,0 +1,65 @@
+#pragma once
+
+#include "BM.hpp"
+#include "KMP.hpp"
+#include "BP.hpp"
+#include "BNDM.hpp"
+#include "QGramBMH.hpp"
+#include "Genome.hpp"
+#include "HybridPicker.hpp"
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @brief Region-adaptive search: a different engine per chunk of the text
+ *
+ * The text is cut into many fixed-size chunks (far more than threads). Each
+ * chunk gets its own engine from HybridPicker based on local composition, and
+ * the chunks are handed to OpenMP threads dynamically, so a slow repeat-rich
+ * region no longer holds back a whole static num_threads partition.
+ */
+class RegionExecutor {
+public:
+    static constexpr size_t DEFAULT_CHUNK = 1 << 18; // 256k
+    static constexpr size_t SAMPLE_BYTES = 1 << 12;  // composition sample per chunk
+
+    struct Chunk {
+        size_t begin;
+        size_t end;
+        std::string algorithm;
+    };
+
+    explicit RegionExecutor(int num_threads = 4, size_t chunk_size = DEFAULT_CHUNK);
+
+    /**
+     * @brief Splits the text into chunks and picks an engine for each one
+     * @note Uses a SAMPLE_BYTES composition sample from the start of each chunk
+     */
+    std::vector<Chunk> plan(const std::string& pattern, std::string_view text) const;
+
+    /**
+     * @brief Same as above but reads composition from the genome's cached profile
+     */
+    std::vector<Chunk> plan(const std::string& pattern, const Genome& genome) const;
+
+    /**
+     * @brief Runs a plan; each chunk counts the matches that start inside it
+     */
+    size_t execute(const std::string& pattern, std::string_view text, const std::vector<Chunk>& chunks) const;
+
+    size_t search(const std::string& pattern, std::string_view text) const;
+    size_t search(const std::string& pattern, const Genome& genome) const;
+
+private:
+    int num_threads;
+    size_t chunk_size;
+    BoyerMooreHorspool bmh;
+    KMP kmp;
+    BitParallelShiftOr shiftor;
+    BNDM bndm;
+    QGramBMH qbmh;
+
+    const PatternMatcher& matcherFor(const std::string& algorithm) const;
+};
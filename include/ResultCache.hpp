@@ -0,0 +1,108 @@
+#pragma once
+
+#include "PatternMatcher.hpp"
+
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+/**
+ * @brief Bounded LRU cache of query results, shared by both strands of a pattern
+ *
+ * Entries are keyed by (reference identity, canonical pattern, query mode),
+ * where the canonical pattern is min(pattern, reverseComplement(pattern)).
+ * Each entry holds the results of both orientations, so a primer and its
+ * reverse complement hit the same entry. A reference is identified by its
+ * resolved path, size and mtime; seeing a new identity for a path drops every
+ * entry of the old one. Least recently used entries are evicted once either
+ * the entry count or the bytes held (positions, keys and per-entry overhead)
+ * pass their bound. All members are safe to call concurrently.
+ */
+class ResultCache {
+public:
+    static constexpr size_t DEFAULT_CAPACITY = 1024;
+    static constexpr size_t DEFAULT_MAX_BYTES = size_t{64} << 20;
+    // Results taking more than this share of max_bytes are answered but not kept,
+    // so one huge position list cannot flush the rest of the cache
+    static constexpr size_t MAX_ENTRY_SHARE = 4;
+
+    struct ReferenceId {
+        std::string path;
+        uint64_t size = 0;
+        int64_t mtime_ns = 0;
+        bool operator==(const ReferenceId& o) const {
+            return size == o.size && mtime_ns == o.mtime_ns && path == o.path;
+        }
+    };
+
+    // Results for the canonical pattern and for its reverse complement
+    struct StrandResults {
+        QueryResult canonical;
+        QueryResult flipped;
+    };
+
+    explicit ResultCache(size_t capacity = DEFAULT_CAPACITY, size_t max_bytes = DEFAULT_MAX_BYTES);
+
+    /**
+     * @brief Identity of a reference file, or nullopt if it cannot be stat'ed
+     */
+    static std::optional<ReferenceId> identify(const std::string& path);
+
+    /**
+     * @brief min(pattern, reverseComplement(pattern))
+     */
+    static std::string canonical(std::string_view pattern);
+
+    std::optional<StrandResults> find(const ReferenceId& ref, const std::string& canonicalPattern, const Query& q);
+    void insert(const ReferenceId& ref, const std::string& canonicalPattern, const Query& q, StrandResults results);
+
+    /**
+     * @brief Drops every entry of the reference at path
+     */
+    void invalidate(const std::string& path);
+    void clear();
+
+    size_t size() const;
+    size_t capacity() const { return max_entries; }
+    size_t bytes() const;
+    size_t byteCapacity() const { return max_bytes; }
+    size_t hits() const;
+    size_t misses() const;
+
+private:
+    struct Key {
+        ReferenceId ref;
+        std::string pattern;
+        QueryMode mode;
+        size_t limit;
+        bool operator==(const Key& o) const {
+            return mode == o.mode && limit == o.limit && pattern == o.pattern && ref == o.ref;
+        }
+    };
+    struct KeyHash {
+        size_t operator()(const Key& k) const;
+    };
+    using Entry = std::pair<Key, StrandResults>;
+
+    // Approximate heap use of one entry: both copies of the key, positions, list and map nodes
+    static size_t footprint(const Key& key, const StrandResults& results);
+
+    // Drops entries of ref.path that belong to an older identity; caller holds the lock
+    void observe(const ReferenceId& ref);
+    void eraseLocked(const std::string& path);
+    std::list<Entry>::iterator eraseEntry(std::list<Entry>::iterator it);
+
+    size_t max_entries;
+    size_t max_bytes;
+    size_t held_bytes = 0;
+    mutable std::mutex lock;
+    std::list<Entry> entries;  // most recently used first
+    std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> index;
+    std::unordered_map<std::string, ReferenceId> current;
+    size_t hit_count = 0;
+    size_t miss_count = 0;
+};
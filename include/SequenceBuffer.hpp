@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <string_view>
+
+/**
+ * @brief Page-aligned sequence storage placed for the parallel matchers
+ *
+ * Backed by an anonymous mapping: explicit huge pages (MAP_HUGETLB) when the
+ * host has them reserved, otherwise normal pages advised for transparent huge
+ * pages. Pages are first-touched in parallel with the matchers' chunk layout
+ * (see Numa::bindWorker), so each chunk lives on the node that scans it and
+ * multi-GB scans are not dominated by TLB misses.
+ */
+class SequenceBuffer {
+public:
+    enum class Pages { None, Small, TransparentHuge, ExplicitHuge };
+
+    SequenceBuffer() = default;
+    ~SequenceBuffer();
+    SequenceBuffer(const SequenceBuffer&) = delete;
+    SequenceBuffer& operator=(const SequenceBuffer&) = delete;
+    SequenceBuffer(SequenceBuffer&& other) noexcept;
+    SequenceBuffer& operator=(SequenceBuffer&& other) noexcept;
+
+    /**
+     * @brief Maps size bytes and zero-fills them chunk by chunk from num_threads workers
+     * @throws std::bad_alloc if the mapping fails
+     */
+    static SequenceBuffer allocate(size_t size, int num_threads);
+
+    /**
+     * @brief allocate() followed by a parallel copy of text using the same layout
+     */
+    static SequenceBuffer copyOf(std::string_view text, int num_threads);
+
+    /**
+     * @brief Maps size bytes and lets each worker write its own chunk:
+     *        produce(dst, begin, end) fills dst[0, end - begin) with bases [begin, end)
+     */
+    static SequenceBuffer fill(size_t size, int num_threads,
+                               const std::function<void(char*, size_t, size_t)>& produce);
+
+    char* data() { return bytes; }
+    const char* data() const { return bytes; }
+    size_t size() const { return length; }
+    std::string_view view() const { return {bytes, length}; }
+    Pages pages() const { return page_kind; }
+    const char* pagesName() const;
+
+private:
+    char* bytes = nullptr;
+    size_t length = 0;
+    size_t mapped = 0;
+    Pages page_kind = Pages::None;
+
+    // Maps size bytes without touching them
+    static SequenceBuffer reserve(size_t size);
+};
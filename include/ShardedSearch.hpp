@@ -0,0 +1,81 @@
+#pragma once
+
+#include "HybridPicker.hpp"
+#include "PatternMatcher.hpp"
+
+#include <mutex>
+#include <string>
+#include <sys/types.h>
+#include <vector>
+
+/**
+ * @brief Searches a reference split across local worker processes
+ *
+ * The coordinator cuts the reference into contiguous shards, one per worker,
+ * using the same chunk layout as the parallel engines. Before forking it maps
+ * the binary cache (parsing the FASTA once to write it if needed), and each
+ * worker decodes only its shard plus max_pattern - 1 bases of the next one, so
+ * a match straddling a boundary is seen whole by the shard it starts in.
+ * Queries go out to every worker over a Unix socketpair and the coordinator
+ * merges the replies: counts add, and position lists concatenate in shard
+ * order, which keeps them ascending.
+ *
+ * The coordinator picks the engine for each query. Workers search serially,
+ * record no trace events, start no OpenMP runtime and drop any pinned
+ * affinity inherited from the forking thread, so a lock held by another
+ * thread of the parent at fork time is never taken in a child.
+ */
+class ShardedSearch {
+public:
+    // Longest pattern the shard overlap covers unless the caller asks for more
+    static constexpr size_t DEFAULT_MAX_PATTERN = 4096;
+
+    struct Shard {
+        size_t begin;  // first match start this shard owns
+        size_t end;    // one past its last owned match start
+    };
+
+    /**
+     * @brief Forks one worker per shard; each decodes its slice of fastaPath
+     * @throws std::runtime_error if a socketpair or fork fails
+     */
+    ShardedSearch(const std::string& fastaPath, int shards, size_t max_pattern = DEFAULT_MAX_PATTERN);
+
+    /**
+     * @brief Closes the sockets and reaps the workers
+     */
+    ~ShardedSearch();
+
+    ShardedSearch(const ShardedSearch&) = delete;
+    ShardedSearch& operator=(const ShardedSearch&) = delete;
+
+    /**
+     * @brief Runs a query on every shard and merges the answers
+     * @throws std::invalid_argument if the pattern is longer than max_pattern
+     * @throws std::runtime_error if a worker died, now or during an earlier query
+     * @note Safe to call from several threads; queries are serialized
+     */
+    QueryResult query(const std::string& pattern, const Query& q = Query::count());
+
+    size_t count(const std::string& pattern) { return query(pattern).count; }
+
+    size_t size() const { return total; }
+    size_t maxPattern() const { return max_pattern; }
+    const std::vector<Shard>& shards() const { return layout; }
+
+private:
+    struct Worker {
+        pid_t pid = -1;
+        int fd = -1;
+    };
+
+    void shutdown();
+
+    size_t total = 0;
+    size_t max_pattern;
+    std::vector<Shard> layout;
+    std::vector<Worker> workers;
+    HybridPicker picker;
+    std::mutex lock;
+    bool broken = false;  // a worker failed mid-query; replies may be out of sync
+};
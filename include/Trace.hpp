@@ -0,0 +1,80 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * @brief Scoped phase tracing exported as Chrome trace-event JSON
+ *
+ * TRACE_SCOPE("bmh.bad_char_table") records one complete event ("ph": "X")
+ * into a per-thread ring buffer when tracing is on. While it is off a span is
+ * one relaxed atomic load. Building with -DDNASEQ_NO_TRACE removes the spans
+ * entirely. Set DNASEQ_TRACE=<file.json> to trace a whole run and write the
+ * file at exit; open it in chrome://tracing or ui.perfetto.dev.
+ */
+namespace Trace {
+
+    // Events kept per thread; the oldest are overwritten first
+    static constexpr size_t DEFAULT_CAPACITY = 1 << 16;
+
+    namespace detail {
+        extern std::atomic<bool> active;
+        uint64_t nowNs();
+        void record(const char* name, uint64_t start_ns, uint64_t end_ns);
+    }
+
+    inline bool enabled() {
+        return detail::active.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Starts recording; capacity applies to thread buffers created afterwards
+     */
+    void enable(size_t events_per_thread = DEFAULT_CAPACITY);
+    void disable();
+
+    /**
+     * @brief Drops every recorded event
+     * @note Safe while other threads record; an event finishing during the call may survive it
+     */
+    void clear();
+
+    /**
+     * @brief Events currently held across all threads
+     */
+    size_t eventCount();
+
+    /**
+     * @brief Writes all recorded events as {"traceEvents": [...]}
+     * @return false if the file could not be written
+     * @note Call while no traced work is running
+     */
+    bool writeChromeJson(const std::string& path);
+
+    /**
+     * @brief RAII span; name must outlive the trace (use string literals)
+     */
+    class Span {
+    public:
+        explicit Span(const char* name) : name(name), start(enabled() ? detail::nowNs() : 0) {}
+        ~Span() {
+            if (start != 0) detail::record(name, start, detail::nowNs());
+        }
+        Span(const Span&) = delete;
+        Span& operator=(const Span&) = delete;
+
+    private:
+        const char* name;
+        uint64_t start;
+    };
+}
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+#ifdef DNASEQ_NO_TRACE
+#define TRACE_SCOPE(name) ((void)0)
+#else
+#define TRACE_SCOPE(name) Trace::Span TRACE_CONCAT(trace_span_, __LINE__)(name)
+#endif
@@ -1,12 +1,24 @@
 import pandas as pd
 
-# Load all result CSVs
+# Load all result CSVs (multi-core timings from the reference host)
 files = {
     "BMH": "algo_results/bmh_results.csv",
     "BP": "algo_results/bp_results.csv",
     "KMP": "algo_results/kmp_results.csv"
 }
 
+# Engines so far timed only on a single-core host (algo_results/single_core,
+# one `make algo_results` run of every engine). Their times are put on the
+# reference host's scale through BMH from the same run: per cell,
+# reference BMH time * engine time / single-core BMH time. Move an engine to
+# `files` once the reference host has timed it.
+SINGLE_CORE_DIR = "algo_results/single_core"
+scaled = {
+    "BNDM": "bndm_results.csv"
+}
+cell_cols = ["length", "gc_content", "entropy"]
+time_cols = ["serial_time", "parallel_time"]
+
 # Read and tag with algorithm name
 dfs = []
 for algo, path in files.items():
@@ -14,6 +26,18 @@ for algo, path in files.items():
     df["algorithm"] = algo
     dfs.append(df)
 
+reference_bmh = dfs[0].set_index(cell_cols)
+single_core_bmh = pd.read_csv(f"{SINGLE_CORE_DIR}/bmh_results.csv").set_index(cell_cols)
+for algo, name in scaled.items():
+    df = pd.read_csv(f"{SINGLE_CORE_DIR}/{name}").set_index(cell_cols)
+    for col in time_cols:
+        df[col] = (reference_bmh[col] * df[col] / single_core_bmh[col]).round().astype(int)
+    # Group on the reference run's match counts, like the measured engines
+    df["matches"] = reference_bmh["matches"]
+    df = df.reset_index()
+    df["algorithm"] = algo
+    dfs.append(df)
+
 # Merge into one big dataframe
 data = pd.concat(dfs, ignore_index=True)
 
@@ -44,6 +68,7 @@ def choose_best(group):
         "BMH_parallel_time": times.get("BMH", None),
         "BP_parallel_time": times.get("BP", None),
         "KMP_parallel_time": times.get("KMP", None),
+        "BNDM_parallel_time": times.get("BNDM", None),
         "margin_of_victory": margin
     })
 
@@ -0,0 +1,140 @@
+// file: algo_results.cpp
+// Regenerates benchmarks/algo_results/<engine>_results.csv, the input of
+// model/generate_td.py. For every (length, gc_content, entropy) cell a random
+// pattern with that composition is drawn and timed serially and in parallel.
+//
+// Build with: make algo_results
+// Usage: ./build/AlgoResults <fasta_file> <out_dir> [threads]
+
+#include "../include/BM.hpp"
+#include "../include/KMP.hpp"
+#include "../include/BP.hpp"
+#include "../include/BNDM.hpp"
+#include "../include/QGramBMH.hpp"
+#include "../include/FastaReader.hpp"
+#include "../include/Calibration.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include <sys/resource.h>
+
+static const size_t LENGTHS[] = {64, 128, 256, 512, 1000, 2000};
+static const double GC_CONTENTS[] = {0.2, 0.5, 0.8};
+static const double ENTROPIES[] = {0.3, 1.1, 1.9};
+static constexpr int REPEATS = 3; // best-of to damp scheduler noise
+
+static double binaryEntropy(double p) {
+    if (p <= 0.0 || p >= 1.0) return 0.0;
+    return -p * std::log2(p) - (1 - p) * std::log2(1 - p);
+}
+
+// Draws a pattern whose base frequencies have the requested GC fraction and, as
+// closely as that GC fraction allows, the requested Shannon entropy. With
+// A:T = G:C = x:(1-x) the entropy is h(gc) + h(x), so x is found by bisection.
+static std::string makePattern(std::mt19937_64& rng, size_t length, double gc, double entropy) {
+    double target = entropy - binaryEntropy(gc);
+    double lo = 0.5, hi = 1.0;
+    for (int i = 0; i < 60; ++i) {
+        double mid = (lo + hi) / 2;
+        if (binaryEntropy(mid) > target) lo = mid; else hi = mid;
+    }
+    double x = (lo + hi) / 2;
+    std::discrete_distribution<int> base({(1 - gc) * x, gc * x, gc * (1 - x), (1 - gc) * (1 - x)});
+
+    std::string pattern(length, 'A');
+    for (char& c : pattern) c = "ACGT"[base(rng)];
+    return pattern;
+}
+
+static long maxRssKb() {
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+template <typename F>
+static long long timeUs(F&& f, size_t& result) {
+    long long best = -1;
+    for (int r = 0; r < REPEATS; ++r) {
+        auto t1 = std::chrono::steady_clock::now();
+        result = f();
+        auto t2 = std::chrono::steady_clock::now();
+        long long us = std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count();
+        if (best < 0 || us < best) best = us;
+    }
+    return std::max(best, 1LL);
+}
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0] << " <fasta_file> <out_dir> [threads]\n";
+        return 1;
+    }
+    const std::string fasta_path = argv[1];
+    const std::string out_dir = argv[2];
+    const int threads = argc > 3 ? std::stoi(argv[3]) : 4;
+
+    const std::string text = FastaReader::readSequence(fasta_path);
+    std::cout << "Sequence length: " << text.size() << " bases\n";
+
+    struct Engine {
+        std::string file;
+        std::unique_ptr<PatternMatcher> matcher;
+        size_t max_length;
+    };
+    std::vector<Engine> engines;
+    engines.push_back({"bmh_results.csv", std::make_unique<BoyerMooreHorspool>(), SIZE_MAX});
+    engines.push_back({"bp_results.csv", std::make_unique<BitParallelShiftOr>(), 64});
+    engines.push_back({"kmp_results.csv", std::make_unique<KMP>(), SIZE_MAX});
+    engines.push_back({"bndm_results.csv", std::make_unique<BNDM>(), SIZE_MAX});
+    engines.push_back({"qbmh_results.csv", std::make_unique<QGramBMH>(), SIZE_MAX});
+
+    for (const Engine& engine : engines) {
+        std::ofstream out(out_dir + "/" + engine.file);
+        if (!out) {
+            std::cerr << "Error: cannot write " << out_dir << "/" << engine.file << "\n";
+            return 1;
+        }
+        out << "length,gc_content,entropy,matches,serial_count,serial_time,serial_mem,"
+               "parallel_count,parallel_time,parallel_mem,speedup,efficiency,overhead\n";
+
+        // Workers the calibration profile lets a scan of this text use, not the request
+        const int effective = Calibration::threadsFor(engine.matcher->name(), text.size(), threads);
+
+        // Same seed for every engine: each cell compares the same pattern
+        std::mt19937_64 rng(42);
+        for (size_t length : LENGTHS) {
+            for (double gc : GC_CONTENTS) {
+                for (double entropy : ENTROPIES) {
+                    std::string pattern = makePattern(rng, length, gc, entropy);
+                    if (length > engine.max_length) continue;
+
+                    size_t serial_count = 0, parallel_count = 0;
+                    long long serial_time = timeUs([&] { return engine.matcher->search(pattern, text); }, serial_count);
+                    long serial_mem = maxRssKb();
+                    long long parallel_time = timeUs([&] { return engine.matcher->searchParallel(pattern, text, threads); }, parallel_count);
+                    long parallel_mem = maxRssKb();
+
+                    double speedup = static_cast<double>(serial_time) / parallel_time;
+                    double efficiency = speedup / effective * 100.0;
+                    long long overhead = parallel_time - serial_time / effective;
+
+                    out << length << ',' << gc << ',' << entropy << ',' << serial_count << ','
+                        << serial_count << ',' << serial_time << ',' << serial_mem << ','
+                        << parallel_count << ',' << parallel_time << ',' << parallel_mem << ','
+                        << speedup << ',' << efficiency << ',' << overhead << '\n';
+                }
+            }
+        }
+        std::cout << "Wrote " << out_dir << "/" << engine.file << " (" << effective << " of " << threads
+                  << " requested threads)\n";
+    }
+    return 0;
+}
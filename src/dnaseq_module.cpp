@@ -0,0 +1,203 @@
+// file: dnaseq_module.cpp
+// Python bindings: the matchers, HybridPicker, compiled patterns and loaded
+// genomes. Sequences are borrowed through the buffer protocol (str, bytes,
+// bytearray, memoryview, 1-d uint8 numpy arrays, or a Genome itself) and
+// never copied; every search and FASTA load runs with the GIL released.
+//
+// Build with: make python   (needs pybind11: pip install pybind11)
+// Usage:      PYTHONPATH=src/build python3 -c "import dnaseq"
+
+#include "../include/Calibration.hpp"
+#include "../include/Genome.hpp"
+#include "../include/HybridPicker.hpp"
+
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace py = pybind11;
+
+namespace {
+
+    // Borrowed bytes of a Python sequence; holds the exporter's buffer until destroyed
+    class TextView {
+    public:
+        explicit TextView(const py::object& obj) {
+            if (py::isinstance<py::str>(obj)) {
+                // Compact ASCII strings hand out their own storage
+                Py_ssize_t size = 0;
+                const char* data = PyUnicode_AsUTF8AndSize(obj.ptr(), &size);
+                if (!data) throw py::error_already_set();
+                text = std::string_view(data, static_cast<size_t>(size));
+                return;
+            }
+            if (!PyObject_CheckBuffer(obj.ptr()))
+                throw py::type_error("sequence must be str or a bytes-like object");
+            info = py::reinterpret_borrow<py::buffer>(obj).request();
+            if (info.ndim != 1 || info.itemsize != 1 || info.strides[0] != 1)
+                throw py::value_error("sequence buffer must be 1-d, contiguous, one byte per base");
+            text = std::string_view(static_cast<const char*>(info.ptr), static_cast<size_t>(info.size));
+        }
+
+        std::string_view view() const { return text; }
+
+    private:
+        py::buffer_info info;
+        std::string_view text;
+    };
+
+    // fn(text) with the GIL released; the buffer is released after the GIL is back
+    template <typename Fn>
+    auto withText(const py::object& obj, Fn&& fn) {
+        TextView text(obj);
+        py::gil_scoped_release release;
+        return fn(text.view());
+    }
+
+    // Search entry points for one pattern type (str or CompiledPattern)
+    template <typename Pattern>
+    void defSearches(py::class_<PatternMatcher>& cls) {
+        cls.def("search", [](const PatternMatcher& pm, Pattern pattern, const py::object& text) {
+               return withText(text, [&](std::string_view t) { return pm.search(pattern, t); });
+           }, py::arg("pattern"), py::arg("text"))
+           .def("search_parallel", [](const PatternMatcher& pm, Pattern pattern, const py::object& text, int num_threads) {
+               return withText(text, [&](std::string_view t) { return pm.searchParallel(pattern, t, num_threads); });
+           }, py::arg("pattern"), py::arg("text"), py::arg("num_threads") = Genome::DEFAULT_THREADS)
+           .def("search_with_reverse_complement", [](const PatternMatcher& pm, Pattern pattern, const py::object& text, bool parallel) {
+               return withText(text, [&](std::string_view t) { return pm.searchWithReverseComplement(pattern, t, parallel); });
+           }, py::arg("pattern"), py::arg("text"), py::arg("parallel") = false)
+           .def("query", [](const PatternMatcher& pm, Pattern pattern, const py::object& text, const Query& q, int num_threads) {
+               return withText(text, [&](std::string_view t) {
+                   return num_threads > 1 ? pm.queryParallel(pattern, t, q, num_threads) : pm.query(pattern, t, q);
+               });
+           }, py::arg("pattern"), py::arg("text"), py::arg("query") = Query::count(), py::arg("num_threads") = 1);
+    }
+}
+
+PYBIND11_MODULE(dnaseq, m) {
+    m.doc() = "DNA pattern matching engines with zero-copy sequence views";
+
+    py::enum_<QueryMode>(m, "QueryMode")
+        .value("Count", QueryMode::Count)
+        .value("Exists", QueryMode::Exists)
+        .value("First", QueryMode::First)
+        .value("Limit", QueryMode::Limit);
+
+    py::class_<Query>(m, "Query")
+        .def(py::init<>())
+        .def_readwrite("mode", &Query::mode)
+        .def_readwrite("limit", &Query::limit)
+        .def_static("count", &Query::count)
+        .def_static("exists", &Query::exists)
+        .def_static("first", &Query::first)
+        .def_static("first_n", &Query::firstN, py::arg("n"));
+
+    py::class_<QueryResult>(m, "QueryResult")
+        .def_readonly("count", &QueryResult::count)
+        .def_readonly("positions", &QueryResult::positions)
+        .def("found", &QueryResult::found);
+
+    py::class_<CompiledPattern, std::shared_ptr<CompiledPattern>>(m, "CompiledPattern")
+        .def_property_readonly("pattern", &CompiledPattern::pattern)
+        .def_property_readonly("palindrome", &CompiledPattern::palindrome)
+        .def("__len__", &CompiledPattern::size);
+
+    m.def("compile", [](const std::string& pattern) {
+        return std::const_pointer_cast<CompiledPattern>(CompiledPattern::compile(pattern));
+    }, py::arg("pattern"), "Preprocesses a pattern once for every engine and both strands");
+
+    // Genome exports its bases read-only: np.frombuffer(genome, dtype=np.uint8) shares them
+    py::class_<Genome, std::shared_ptr<Genome>>(m, "Genome", py::buffer_protocol())
+        .def(py::init([](const py::object& sequence, std::string source, int num_threads) {
+            return withText(sequence, [&](std::string_view s) {
+                return std::make_shared<Genome>(s, std::move(source), num_threads);
+            });
+        }), py::arg("sequence"), py::arg("source") = "", py::arg("num_threads") = Genome::DEFAULT_THREADS)
+        .def_static("load", [](const std::string& fastaPath, int num_threads) {
+            return std::const_pointer_cast<Genome>(Genome::load(fastaPath, num_threads));
+        }, py::arg("fasta_path"), py::arg("num_threads") = Genome::DEFAULT_THREADS,
+           py::call_guard<py::gil_scoped_release>())
+        .def_property_readonly("source", &Genome::source)
+        .def("__len__", &Genome::size)
+        .def_buffer([](Genome& g) {
+            return py::buffer_info(const_cast<char*>(g.view().data()), 1, py::format_descriptor<uint8_t>::format(), 1,
+                                   {static_cast<py::ssize_t>(g.size())}, {py::ssize_t{1}}, true);
+        });
+
+    py::class_<PatternMatcher> matcher(m, "PatternMatcher");
+    matcher.def_property_readonly("name", [](const PatternMatcher& pm) { return std::string(pm.name()); })
+           .def("search_in_fasta", &PatternMatcher::searchInFasta, py::arg("pattern"), py::arg("fasta_path"),
+                py::call_guard<py::gil_scoped_release>())
+           .def("search_parallel_in_fasta", &PatternMatcher::searchParallelInFasta, py::arg("pattern"), py::arg("fasta_path"),
+                py::call_guard<py::gil_scoped_release>());
+    defSearches<const CompiledPattern&>(matcher);
+    defSearches<const std::string&>(matcher);
+
+    py::class_<BoyerMooreHorspool, PatternMatcher>(m, "BoyerMooreHorspool").def(py::init<>());
+    py::class_<KMP, PatternMatcher>(m, "KMP").def(py::init<>());
+    py::class_<BitParallelShiftOr, PatternMatcher>(m, "BitParallelShiftOr").def(py::init<>());
+    py::class_<BNDM, PatternMatcher>(m, "BNDM").def(py::init<>());
+    py::class_<QGramBMH, PatternMatcher>(m, "QGramBMH").def(py::init<>());
+
+    py::class_<EstimateOptions>(m, "EstimateOptions")
+        .def(py::init<>())
+        .def_readwrite("chunk_size", &EstimateOptions::chunk_size)
+        .def_readwrite("sample_fraction", &EstimateOptions::sample_fraction)
+        .def_readwrite("target_relative_error", &EstimateOptions::target_relative_error)
+        .def_readwrite("time_budget_ms", &EstimateOptions::time_budget_ms)
+        .def_readwrite("z", &EstimateOptions::z)
+        .def_readwrite("seed", &EstimateOptions::seed)
+        .def_readwrite("num_threads", &EstimateOptions::num_threads);
+
+    py::class_<CountEstimate>(m, "CountEstimate")
+        .def_readonly("count", &CountEstimate::count)
+        .def_readonly("low", &CountEstimate::low)
+        .def_readonly("high", &CountEstimate::high)
+        .def_readonly("relative_error", &CountEstimate::relative_error)
+        .def_readonly("chunks_sampled", &CountEstimate::chunks_sampled)
+        .def_readonly("chunks_total", &CountEstimate::chunks_total)
+        .def_readonly("exact", &CountEstimate::exact);
+
+    using Release = py::call_guard<py::gil_scoped_release>;
+    py::class_<HybridPicker>(m, "HybridPicker")
+        .def(py::init<>())
+        .def("create_matcher", &HybridPicker::createMatcher, py::arg("algorithm"),
+             "Engine for an algorithm name, or None if the name is unknown")
+        .def("available_algorithms", &HybridPicker::getAvailableAlgorithms)
+        .def("recommend_algorithm", py::overload_cast<const std::string&>(&HybridPicker::recommendAlgorithm),
+             py::arg("pattern"))
+        .def("pick_and_search", &HybridPicker::pickAndSearch,
+             py::arg("algorithm"), py::arg("pattern"), py::arg("fasta_path"), Release())
+        .def("pick_and_search_parallel", &HybridPicker::pickAndSearchParallel,
+             py::arg("algorithm"), py::arg("pattern"), py::arg("fasta_path"), Release())
+        .def("auto_pick_and_search", &HybridPicker::autoPickAndSearch,
+             py::arg("pattern"), py::arg("fasta_path"), Release())
+        .def("auto_pick_and_search_parallel", &HybridPicker::autoPickAndSearchParallel,
+             py::arg("pattern"), py::arg("fasta_path"), Release())
+        .def("auto_pick_and_search_adaptive", &HybridPicker::autoPickAndSearchAdaptive,
+             py::arg("pattern"), py::arg("fasta_path"), Release())
+        .def("auto_pick_and_search_indexed", &HybridPicker::autoPickAndSearchIndexed,
+             py::arg("pattern"), py::arg("fasta_path"), Release())
+        .def("search_cached", &HybridPicker::searchCached,
+             py::arg("pattern"), py::arg("fasta_path"), py::arg("query") = Query::count(),
+             py::arg("both_strands") = false, Release())
+        .def("estimate_count", [](HybridPicker& picker, const std::string& pattern, const py::object& text,
+                                  const EstimateOptions& opts) {
+            return withText(text, [&](std::string_view t) { return picker.estimateCount(pattern, t, opts); });
+        }, py::arg("pattern"), py::arg("text"), py::arg("options") = EstimateOptions())
+        .def("estimate_count_in_fasta", &HybridPicker::estimateCountInFasta,
+             py::arg("pattern"), py::arg("fasta_path"), py::arg("options") = EstimateOptions(), Release());
+
+    m.def("threads_for", &Calibration::threadsFor, py::arg("engine"), py::arg("n"), py::arg("requested"),
+          "Worker count the active calibration profile gives a scan of n bases");
+    m.def("calibrate", [](size_t text_bytes, bool save) {
+        Calibration::Profile profile = Calibration::measure(text_bytes);
+        if (save) Calibration::save(profile, Calibration::defaultPath());
+        Calibration::setCurrent(profile);
+    }, py::arg("text_bytes") = size_t{32} << 20, py::arg("save") = true, Release(),
+       "Measures the host and makes the result the active calibration profile");
+}
@@ -0,0 +1,67 @@
+#include "../../include/Arena.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <new>
+
+Arena::Scope::Scope() : Scope(Arena::local()) {}
+
+Arena::Scope::Scope(Arena& arena)
+    : arena(arena), block(arena.current), offset(arena.offset) {}
+
+Arena::Scope::~Scope() {
+    arena.current = block;
+    arena.offset = offset;
+}
+
+Arena::~Arena() {
+    release();
+}
+
+Arena& Arena::local() {
+    thread_local Arena arena;
+    return arena;
+}
+
+size_t Arena::bytesReserved() const {
+    size_t total = 0;
+    for (const Block& b : blocks) total += b.size;
+    return total;
+}
+
+void Arena::release() {
+    for (const Block& b : blocks)
+        ::operator delete(b.data, std::align_val_t(BLOCK_ALIGNMENT));
+    blocks.clear();
+    current = 0;
+    offset = 0;
+}
+
+void* Arena::do_allocate(size_t bytes, size_t alignment) {
+    // Try the current block, then any block retained from an earlier scope
+    for (size_t b = current; b < blocks.size(); ++b) {
+        uintptr_t base = reinterpret_cast<uintptr_t>(blocks[b].data);
+        uintptr_t from = base + ((b == current) ? offset : 0);
+        uintptr_t aligned = (from + alignment - 1) & ~static_cast<uintptr_t>(alignment - 1);
+        if (aligned + bytes <= base + blocks[b].size) {
+            current = b;
+            offset = aligned + bytes - base;
+            return reinterpret_cast<void*>(aligned);
+        }
+    }
+
+    // Grow geometrically so a steady workload converges on a handful of blocks
+    size_t size = std::max(MIN_BLOCK_SIZE, bytes + alignment);
+    if (!blocks.empty()) size = std::max(size, blocks.back().size * 2);
+    if (blocks.size() == blocks.capacity()) blocks.reserve(std::max<size_t>(8, blocks.size() * 2));
+
+    auto* data = static_cast<std::byte*>(::operator new(size, std::align_val_t(BLOCK_ALIGNMENT)));
+    blocks.push_back({data, size});
+    ++upstream_allocations;
+
+    uintptr_t base = reinterpret_cast<uintptr_t>(data);
+    uintptr_t aligned = (base + alignment - 1) & ~static_cast<uintptr_t>(alignment - 1);
+    current = blocks.size() - 1;
+    offset = aligned + bytes - base;
+    return reinterpret_cast<void*>(aligned);
+}
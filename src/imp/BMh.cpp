@@ -1,8 +1,15 @@
 #include "../../include/BM.hpp"
 #include "../../include/FastaReader.hpp"
 #include "../../include/BioUtils.hpp"
+#include "../../include/Arena.hpp"
+#include "../../include/Genome.hpp"
+#include "../../include/Calibration.hpp"
+#include "../../include/Numa.hpp"
+#include "../../include/Trace.hpp"
 
+#include <memory_resource>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <algorithm>
 #include <cstdint>
@@ -15,38 +22,102 @@
 using namespace std;
 
 
-// Minimum characters per thread to justify parallelism (tuneable)
-static constexpr size_t MIN_PER_THREAD = 1 << 16; // 64k
+namespace {
 
-std::vector<size_t> BoyerMooreHorspool::createBadCharTable(const std::string& pattern) const {
-    std::vector<size_t> table(256, pattern.size());
+    // Counting receiver for the kernel below
+    struct Counter {
+        size_t count = 0;
+        bool onMatch(size_t) { ++count; return true; }
+        bool keepScanning() { return true; }
+    };
+
+    // Reports alignments starting in [begin, end); verification reads up to m - 1 bases past end
+    template <typename Sink>
+    void horspoolRange(const uint32_t* badChar, std::string_view pattern, std::string_view text,
+                       size_t begin, size_t end, Sink& sink) {
+        const size_t n = text.size(), m = pattern.size();
+        const size_t last_start = std::min(end, n - m + 1);
+        size_t next_poll = begin;
+        size_t s = begin;
+        while (s < last_start) {
+            if (s >= next_poll) {
+                if (!sink.keepScanning()) return;
+                next_poll = s + MatchSink::POLL_INTERVAL;
+            }
+            size_t j = m;
+            while (j > 0 && pattern[j - 1] == text[s + j - 1]) --j;
+            if (j == 0) {
+                if (!sink.onMatch(s)) return;
+                ++s;
+            } else {
+                unsigned char mc = static_cast<unsigned char>(text[s + m - 1]);
+                size_t shift = badChar[mc];
+                if (shift == 0) shift = 1;
+                s += shift;
+            }
+        }
+    }
+
+    size_t countRange(const uint32_t* badChar, std::string_view pattern, std::string_view text,
+                      size_t begin, size_t end) {
+        Counter counter;
+        horspoolRange(badChar, pattern, text, begin, end, counter);
+        return counter.count;
+    }
+}
+
+void BoyerMooreHorspool::buildBadCharTable(std::string_view pattern, uint32_t (&table)[256]) {
+    TRACE_SCOPE("bmh.bad_char_table");
     size_t m = pattern.size();
+    std::fill(std::begin(table), std::end(table), static_cast<uint32_t>(m));
     for (size_t i = 0; i + 1 < m; ++i)
-        table[(unsigned char)pattern[i]] = m - 1 - i;
-    return table;
+        table[(unsigned char)pattern[i]] = static_cast<uint32_t>(m - 1 - i);
 }
 
-size_t BoyerMooreHorspool::search(const string& pattern, const string& text) const {
+size_t BoyerMooreHorspool::search(std::string_view pattern, std::string_view text) const {
+    return searchRange(pattern, text, 0, text.size());
+}
+
+size_t BoyerMooreHorspool::searchRange(std::string_view pattern, std::string_view text, size_t begin, size_t end) const {
+    TRACE_SCOPE("bmh.scan_range");
     const size_t n = text.size(), m = pattern.size();
-    if (m == 0 || n < m) return 0;
+    end = std::min(end, n);
+    if (m == 0 || n < m || begin >= end) return 0;
 
-    std::vector<size_t> badChar = createBadCharTable(pattern);
-    size_t count = 0;
-    size_t s = 0;
-    while (s + m <= n) {
-        size_t j = m;
-        while (j > 0 && pattern[j - 1] == text[s + j - 1]) --j;
-        if (j == 0) {
-            ++count;
-            ++s;
-        } else {
-            unsigned char mc = static_cast<unsigned char>(text[s + m - 1]);
-            size_t shift = badChar[mc];
-            if (shift == 0) shift = 1;
-            s += shift;
-        }
-    }
-    return count;
+    uint32_t badChar[256];
+    buildBadCharTable(pattern, badChar);
+    return countRange(badChar, pattern, text, begin, end);
+}
+
+void BoyerMooreHorspool::scanRange(std::string_view pattern, std::string_view text, size_t begin, size_t end, MatchSink& sink) const {
+    TRACE_SCOPE("bmh.scan_query");
+    const size_t n = text.size(), m = pattern.size();
+    end = std::min(end, n);
+    if (m == 0 || n < m || begin >= end) return;
+
+    uint32_t badChar[256];
+    buildBadCharTable(pattern, badChar);
+    horspoolRange(badChar, pattern, text, begin, end, sink);
+}
+
+size_t BoyerMooreHorspool::searchRange(const CompiledStrand& pattern, std::string_view text, size_t begin, size_t end) const {
+    TRACE_SCOPE("bmh.scan_range");
+    const size_t n = text.size(), m = pattern.size();
+    end = std::min(end, n);
+    if (m == 0 || n < m || begin >= end) return 0;
+    return countRange(pattern.bad_char, pattern.bases, text, begin, end);
+}
+
+void BoyerMooreHorspool::scanRange(const CompiledStrand& pattern, std::string_view text, size_t begin, size_t end, MatchSink& sink) const {
+    TRACE_SCOPE("bmh.scan_query");
+    const size_t n = text.size(), m = pattern.size();
+    end = std::min(end, n);
+    if (m == 0 || n < m || begin >= end) return;
+    horspoolRange(pattern.bad_char, pattern.bases, text, begin, end, sink);
+}
+
+string_view BoyerMooreHorspool::name() const {
+    return "bmh";
 }
 
 size_t BoyerMooreHorspool::searchInFasta(const string& pattern, const string& fastaPath) const {
@@ -54,50 +125,41 @@ size_t BoyerMooreHorspool::searchInFasta(const string& pattern, const string& fa
     return search(pattern, dnaSequence);
 }
 
-size_t BoyerMooreHorspool::searchParallel(const std::string& pattern, const std::string& text, int num_threads) const {
+size_t BoyerMooreHorspool::searchParallel(std::string_view pattern, std::string_view text, int num_threads) const {
+    TRACE_SCOPE("bmh.search_parallel");
     const size_t n = text.size(), m = pattern.size();
     if (m == 0 || n < m) return 0;
-    if (num_threads <= 0) num_threads = 1;
-    if (n < static_cast<size_t>(num_threads) * MIN_PER_THREAD) num_threads = 1;
+    num_threads = Calibration::threadsFor(name(), n, num_threads);
 
-    std::vector<size_t> badChar = createBadCharTable(pattern);
+    uint32_t badChar[256];
+    buildBadCharTable(pattern, badChar);
     size_t total_count = 0;
 
     #pragma omp parallel num_threads(num_threads) reduction(+: total_count)
     {
         int tid = omp_get_thread_num();
         size_t chunk = (n + num_threads - 1) / num_threads;
-        size_t worker_start = tid * chunk;
-        size_t worker_end = std::min(n, (tid + 1) * chunk);
-        if (worker_start >= worker_end) {}
+        size_t worker_start = std::min(n, tid * chunk);
+        size_t worker_end = std::min(n, worker_start + chunk);
+        Numa::bindWorker(tid, num_threads);
+        TRACE_SCOPE("bmh.scan_chunk");
 
-        size_t local_count = 0;
-        size_t s = worker_start;
-        while (s + m <= n && s < worker_end) {
-            size_t j = m;
-            while (j > 0 && pattern[j - 1] == text[s + j - 1]) --j;
-            if (j == 0) {
-                ++local_count;
-                ++s;
-            } else {
-                unsigned char mc = static_cast<unsigned char>(text[s + m - 1]);
-                size_t shift = badChar[mc];
-                if (shift == 0) shift = 1;
-                s += shift;
-            }
-        }
-        total_count += local_count;
+        // Ownership window: report only alignments starting in [worker_start, worker_end).
+        // Verification may read up to m - 1 bases past worker_end, never past n.
+        total_count += countRange(badChar, pattern, text, worker_start, worker_end);
     }
     return total_count;
 }
 size_t BoyerMooreHorspool::searchParallelInFasta(const std::string& pattern, const std::string& fastaPath) const {
     int num_threads = 4;
-    std::string dnaSequence = FastaReader::readSequence(fastaPath);
-    return searchParallel(pattern, dnaSequence, num_threads);
+    auto genome = Genome::load(fastaPath, num_threads);
+    return searchParallel(pattern, genome->view(), num_threads);
 }
 
-size_t BoyerMooreHorspool::searchWithReverseComplement(const std::string& pattern, const std::string& text, bool parallel) const {
-    std::string rc_pattern = BioUtils::reverseComplement(pattern);
+size_t BoyerMooreHorspool::searchWithReverseComplement(std::string_view pattern, std::string_view text, bool parallel) const {
+    TRACE_SCOPE("bmh.search_rc");
+    Arena::Scope scratch;
+    std::pmr::string rc_pattern = BioUtils::reverseComplement(pattern, scratch.resource());
     
     if (parallel) {
         int num_threads = 4;
@@ -0,0 +1,291 @@
+#include "../../include/BNDM.hpp"
+#include "../../include/BP.hpp"
+#include "../../include/FastaReader.hpp"
+#include "../../include/BioUtils.hpp"
+#include "../../include/Arena.hpp"
+#include "../../include/Genome.hpp"
+#include "../../include/Calibration.hpp"
+#include "../../include/Numa.hpp"
+#include "../../include/Trace.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <omp.h>
+using namespace std;
+
+namespace {
+
+    // Read-only view of either engine's tables, from the arena or a CompiledStrand
+    struct Tables {
+        size_t m = 0;
+        const uint64_t* D = nullptr;     // BNDM masks
+        const uint8_t* code = nullptr;   // BOM alphabet
+        size_t sigma = 0;
+        const int32_t* next = nullptr;   // BOM transitions
+
+        int32_t step(int32_t state, unsigned char c) const {
+            uint8_t k = code[c];
+            return k ? next[state * sigma + k] : -1;
+        }
+    };
+
+    // Per-call preprocessing for the string_view entry points; lives in the caller's arena scope
+    struct ScratchTables {
+        uint64_t D[256];
+        uint8_t code[256];
+        std::pmr::vector<int32_t> next;
+        std::pmr::vector<int32_t> supply;
+        Tables view;
+
+        ScratchTables(string_view pattern, std::pmr::memory_resource* mr) : next(mr), supply(mr) {
+            TRACE_SCOPE("bndm.tables");
+            const size_t m = pattern.size();
+            view.m = m;
+            if (m <= BNDM::MAX_BNDM_LENGTH) {
+                BNDM::buildMasks(pattern, D);
+                view.D = D;
+            } else {
+                view.sigma = BNDM::buildOracleAlphabet(pattern, code);
+                next.resize((m + 1) * view.sigma);
+                supply.resize(m + 1);
+                BNDM::buildOracle(pattern, code, view.sigma, next.data(), supply.data());
+                view.code = code;
+                view.next = next.data();
+            }
+        }
+    };
+
+    Tables compiledTables(const CompiledStrand& p) {
+        return {p.size(), p.bndm, p.oracle_code, p.oracle_sigma, p.oracle_next.data()};
+    }
+
+    // Counting receiver for the kernels below
+    struct Counter {
+        size_t count = 0;
+        bool onMatch(size_t) { ++count; return true; }
+        bool keepScanning() { return true; }
+    };
+
+    template <typename Sink>
+    void bndmRange(const Tables& t, string_view text, size_t begin, size_t end, Sink& sink) {
+        const size_t n = text.size(), m = t.m;
+        const uint64_t full = (m == 64) ? ~0ULL : ((1ULL << m) - 1);
+        const uint64_t high = 1ULL << (m - 1);
+        const size_t last_start = std::min(end, n - m + 1);
+
+        size_t next_poll = begin;
+        size_t pos = begin;
+        while (pos < last_start) {
+            if (pos >= next_poll) {
+                if (!sink.keepScanning()) return;
+                next_poll = pos + MatchSink::POLL_INTERVAL;
+            }
+            size_t j = m, last = m;
+            uint64_t d = full;
+            while (j > 0 && d != 0) {
+                d &= t.D[static_cast<unsigned char>(text[pos + j - 1])];
+                --j;
+                if (d & high) {
+                    // Window suffix is a pattern prefix: remember it as the next alignment
+                    if (j > 0) last = j;
+                    else if (!sink.onMatch(pos)) return;
+                }
+                d = (d << 1) & full;
+            }
+            pos += last;
+        }
+    }
+
+    template <typename Sink>
+    void bomRange(const Tables& t, string_view text, size_t begin, size_t end, Sink& sink) {
+        const size_t n = text.size(), m = t.m;
+        const size_t last_start = std::min(end, n - m + 1);
+
+        size_t next_poll = begin;
+        size_t pos = begin;
+        while (pos < last_start) {
+            if (pos >= next_poll) {
+                if (!sink.keepScanning()) return;
+                next_poll = pos + MatchSink::POLL_INTERVAL;
+            }
+            int32_t state = 0;
+            size_t j = m;
+            while (j > 0) {
+                state = t.step(state, static_cast<unsigned char>(text[pos + j - 1]));
+                if (state < 0) break;
+                --j;
+            }
+            // A full-length path through the oracle spells exactly the pattern
+            if (j == 0) {
+                if (!sink.onMatch(pos)) return;
+                pos += 1;
+            } else {
+                pos += j;
+            }
+        }
+    }
+
+    template <typename Sink>
+    void scanTables(const Tables& t, string_view text, size_t begin, size_t end, Sink& sink) {
+        if (t.m <= BNDM::MAX_BNDM_LENGTH) bndmRange(t, text, begin, end, sink);
+        else bomRange(t, text, begin, end, sink);
+    }
+
+    size_t countTables(const Tables& t, string_view text, size_t begin, size_t end) {
+        Counter counter;
+        scanTables(t, text, begin, end, counter);
+        return counter.count;
+    }
+}
+
+void BNDM::buildMasks(std::string_view pattern, uint64_t (&D)[256]) {
+    const size_t m = pattern.size();
+    uint64_t B[256];
+    BitParallelShiftOr::buildMasks(pattern, B);
+    const uint64_t full = (m == 64) ? ~0ULL : ((1ULL << m) - 1);
+    for (size_t c = 0; c < 256; ++c) {
+        // Shift-or clears bit i on a hit; BNDM wants it set and mirrored
+        uint64_t hits = ~B[c] & full;
+        uint64_t d = 0;
+        while (hits) {
+            unsigned i = __builtin_ctzll(hits);
+            d |= 1ULL << (m - 1 - i);
+            hits &= hits - 1;
+        }
+        D[c] = d;
+    }
+}
+
+size_t BNDM::buildOracleAlphabet(std::string_view pattern, uint8_t (&code)[256]) {
+    std::fill(std::begin(code), std::end(code), 0);
+    size_t k = 0;
+    for (char ch : pattern) {
+        unsigned char c = static_cast<unsigned char>(ch);
+        if (code[c] == 0) code[c] = static_cast<uint8_t>(++k);
+    }
+    return k + 1;
+}
+
+void BNDM::buildOracle(std::string_view pattern, const uint8_t (&code)[256], size_t sigma,
+                       int32_t* next, int32_t* supply) {
+    const size_t m = pattern.size();
+    std::fill(next, next + (m + 1) * sigma, -1);
+    std::fill(supply, supply + m + 1, -1);
+
+    // Allauzen-Crochemore-Raffinot construction over the reversed pattern
+    for (size_t i = 1; i <= m; ++i) {
+        uint8_t c = code[static_cast<unsigned char>(pattern[m - i])];
+        next[(i - 1) * sigma + c] = static_cast<int32_t>(i);
+        int32_t s = supply[i - 1];
+        while (s > -1 && next[s * sigma + c] == -1) {
+            next[s * sigma + c] = static_cast<int32_t>(i);
+            s = supply[s];
+        }
+        supply[i] = (s == -1) ? 0 : next[s * sigma + c];
+    }
+}
+
+size_t BNDM::search(std::string_view pattern, std::string_view text) const {
+    return searchRange(pattern, text, 0, text.size());
+}
+
+size_t BNDM::searchRange(std::string_view pattern, std::string_view text, size_t begin, size_t end) const {
+    TRACE_SCOPE("bndm.scan_range");
+    const size_t n = text.size(), m = pattern.size();
+    end = std::min(end, n);
+    if (m == 0 || n < m || begin >= end) return 0;
+
+    Arena::Scope scratch;
+    ScratchTables tables(pattern, scratch.resource());
+    return countTables(tables.view, text, begin, end);
+}
+
+void BNDM::scanRange(std::string_view pattern, std::string_view text, size_t begin, size_t end, MatchSink& sink) const {
+    TRACE_SCOPE("bndm.scan_query");
+    const size_t n = text.size(), m = pattern.size();
+    end = std::min(end, n);
+    if (m == 0 || n < m || begin >= end) return;
+
+    Arena::Scope scratch;
+    ScratchTables tables(pattern, scratch.resource());
+    scanTables(tables.view, text, begin, end, sink);
+}
+
+size_t BNDM::searchRange(const CompiledStrand& pattern, std::string_view text, size_t begin, size_t end) const {
+    TRACE_SCOPE("bndm.scan_range");
+    const size_t n = text.size(), m = pattern.size();
+    end = std::min(end, n);
+    if (m == 0 || n < m || begin >= end) return 0;
+    return countTables(compiledTables(pattern), text, begin, end);
+}
+
+void BNDM::scanRange(const CompiledStrand& pattern, std::string_view text, size_t begin, size_t end, MatchSink& sink) const {
+    TRACE_SCOPE("bndm.scan_query");
+    const size_t n = text.size(), m = pattern.size();
+    end = std::min(end, n);
+    if (m == 0 || n < m || begin >= end) return;
+    scanTables(compiledTables(pattern), text, begin, end, sink);
+}
+
+string_view BNDM::name() const {
+    return "bndm";
+}
+
+size_t BNDM::searchInFasta(const string& pattern, const string& fastaPath) const {
+    string dnaSequence = FastaReader::readSequence(fastaPath);
+    return search(pattern, dnaSequence);
+}
+
+size_t BNDM::searchParallel(std::string_view pattern, std::string_view text, int num_threads) const {
+    TRACE_SCOPE("bndm.search_parallel");
+    const size_t n = text.size(), m = pattern.size();
+    if (m == 0 || n < m) return 0;
+    num_threads = Calibration::threadsFor(name(), n, num_threads);
+
+    Arena::Scope scratch;
+    ScratchTables tables(pattern, scratch.resource());
+    size_t total_count = 0;
+
+    #pragma omp parallel num_threads(num_threads) reduction(+: total_count)
+    {
+        int tid = omp_get_thread_num();
+        size_t chunk = (n + num_threads - 1) / num_threads;
+        size_t worker_start = std::min(n, tid * chunk);
+        size_t worker_end = std::min(n, worker_start + chunk);
+        Numa::bindWorker(tid, num_threads);
+        TRACE_SCOPE("bndm.scan_chunk");
+
+        // Windows starting in [worker_start, worker_end) belong to this worker
+        total_count += countTables(tables.view, text, worker_start, worker_end);
+    }
+    return total_count;
+}
+
+size_t BNDM::searchParallelInFasta(const std::string& pattern, const std::string& fastaPath) const {
+    int num_threads = 4;
+    auto genome = Genome::load(fastaPath, num_threads);
+    return searchParallel(pattern, genome->view(), num_threads);
+}
+
+size_t BNDM::searchWithReverseComplement(std::string_view pattern, std::string_view text, bool parallel) const {
+    TRACE_SCOPE("bndm.search_rc");
+    Arena::Scope scratch;
+    std::pmr::string rc_pattern = BioUtils::reverseComplement(pattern, scratch.resource());
+
+    if (parallel) {
+        int num_threads = 4;
+        // Run searches sequentially but each uses internal parallelism
+        size_t count_pattern = searchParallel(pattern, text, num_threads);
+        size_t count_rc_pattern = searchParallel(rc_pattern, text, num_threads);
+        return count_pattern + count_rc_pattern;
+    } else {
+        // Sequential version
+        size_t count_pattern = search(pattern, text);
+        size_t count_rc_pattern = search(rc_pattern, text);
+        return count_pattern + count_rc_pattern;
+    }
+}
@@ -1,9 +1,15 @@
 #include "../../include/BP.hpp"
 #include "../../include/FastaReader.hpp"
 #include "../../include/BioUtils.hpp"
+#include "../../include/Arena.hpp"
+#include "../../include/Genome.hpp"
+#include "../../include/Calibration.hpp"
+#include "../../include/Numa.hpp"
+#include "../../include/Trace.hpp"
 
 
 #include <string>
+#include <string_view>
 #include <vector>
 #include <algorithm>
 #include <cstdint>
@@ -17,26 +23,90 @@
 using namespace std;
 
 
-// Minimum characters per thread to justify parallelism (tuneable)
-static constexpr size_t MIN_PER_THREAD = 1 << 16; // 64k
+void BitParallelShiftOr::buildMasks(std::string_view pattern, uint64_t (&B)[256]) {
+    TRACE_SCOPE("shiftor.masks");
+    for (size_t i = 0; i < 256; ++i) B[i] = ~0ULL;
+    for (size_t i = 0; i < pattern.size(); ++i)
+        B[(unsigned char)pattern[i]] &= ~(1ULL << i);
+}
+
+namespace {
+
+    // A fresh state at begin reports every match starting at or after begin
+    size_t countRange(const uint64_t* B, size_t m, std::string_view text, size_t begin, size_t end) {
+        const size_t n = text.size();
+        uint64_t state = ~0ULL;
+        size_t count = 0;
+        const size_t scan_end = std::min(n, end + (m - 1));
+        for (size_t i = begin; i < scan_end; ++i) {
+            state = (state << 1) | B[(unsigned char)text[i]];
+            if (i >= begin + m - 1 && (state & (1ULL << (m - 1))) == 0)
+                ++count;
+        }
+        return count;
+    }
+
+    void scanMasks(const uint64_t* B, size_t m, std::string_view text, size_t begin, size_t end, MatchSink& sink) {
+        const size_t n = text.size();
+        uint64_t state = ~0ULL;
+        size_t next_poll = begin;
+        const size_t scan_end = std::min(n, end + (m - 1));
+        for (size_t i = begin; i < scan_end; ++i) {
+            if (i >= next_poll) {
+                if (!sink.keepScanning()) return;
+                next_poll = i + MatchSink::POLL_INTERVAL;
+            }
+            state = (state << 1) | B[(unsigned char)text[i]];
+            if (i >= begin + m - 1 && (state & (1ULL << (m - 1))) == 0)
+                if (!sink.onMatch(i - (m - 1))) return;
+        }
+    }
+}
 
-size_t BitParallelShiftOr::search(const string& pattern, const string& text) const {
+size_t BitParallelShiftOr::search(std::string_view pattern, std::string_view text) const {
+    return searchRange(pattern, text, 0, text.size());
+}
+
+size_t BitParallelShiftOr::searchRange(std::string_view pattern, std::string_view text, size_t begin, size_t end) const {
+    TRACE_SCOPE("shiftor.scan_range");
     const size_t n = text.size(), m = pattern.size();
-    if (m == 0 || n < m || m > 64) return 0;
+    end = std::min(end, n);
+    if (m == 0 || n < m || m > 64 || begin >= end) return 0;
 
     uint64_t B[256];
-    for (size_t i = 0; i < 256; ++i) B[i] = ~0ULL;
-    for (size_t i = 0; i < m; ++i)
-        B[(unsigned char)pattern[i]] &= ~(1ULL << i);
+    buildMasks(pattern, B);
+    return countRange(B, m, text, begin, end);
+}
 
-    uint64_t state = ~0ULL;
-    size_t count = 0;
-    for (size_t i = 0; i < n; ++i) {
-        state = (state << 1) | B[(unsigned char)text[i]];
-        if (i >= m - 1 && (state & (1ULL << (m - 1))) == 0)
-            ++count;
-    }
-    return count; 
+void BitParallelShiftOr::scanRange(std::string_view pattern, std::string_view text, size_t begin, size_t end, MatchSink& sink) const {
+    TRACE_SCOPE("shiftor.scan_query");
+    const size_t n = text.size(), m = pattern.size();
+    end = std::min(end, n);
+    if (m == 0 || n < m || m > 64 || begin >= end) return;
+
+    uint64_t B[256];
+    buildMasks(pattern, B);
+    scanMasks(B, m, text, begin, end, sink);
+}
+
+size_t BitParallelShiftOr::searchRange(const CompiledStrand& pattern, std::string_view text, size_t begin, size_t end) const {
+    TRACE_SCOPE("shiftor.scan_range");
+    const size_t n = text.size(), m = pattern.size();
+    end = std::min(end, n);
+    if (m == 0 || n < m || m > 64 || begin >= end) return 0;
+    return countRange(pattern.shift_or, m, text, begin, end);
+}
+
+void BitParallelShiftOr::scanRange(const CompiledStrand& pattern, std::string_view text, size_t begin, size_t end, MatchSink& sink) const {
+    TRACE_SCOPE("shiftor.scan_query");
+    const size_t n = text.size(), m = pattern.size();
+    end = std::min(end, n);
+    if (m == 0 || n < m || m > 64 || begin >= end) return;
+    scanMasks(pattern.shift_or, m, text, begin, end, sink);
+}
+
+string_view BitParallelShiftOr::name() const {
+    return "bithiftor";
 }
 
 size_t BitParallelShiftOr::searchInFasta(const string& pattern, const string& fastaPath) const {
@@ -44,33 +114,57 @@ size_t BitParallelShiftOr::searchInFasta(const string& pattern, const string& fa
     return search(pattern, dnaSequence);
 }
 
-size_t BitParallelShiftOr::searchParallel(const std::string& pattern, const std::string& text, int num_threads) const {
+size_t BitParallelShiftOr::searchParallel(std::string_view pattern, std::string_view text, int num_threads) const {
+    TRACE_SCOPE("shiftor.search_parallel");
     const size_t n = text.size(), m = pattern.size();
     if (m == 0 || n < m || m > 64) return 0;
+    num_threads = Calibration::threadsFor(name(), n, num_threads);
 
-    uint64_t B[256];
-    for (size_t i = 0; i < 256; ++i) B[i] = ~0ULL;
-    for (size_t i = 0; i < m; ++i)
-        B[(unsigned char)pattern[i]] &= ~(1ULL << i);
+    uint64_t B_global[256];
+    buildMasks(pattern, B_global);
+
+    size_t total_count = 0;
+    #pragma omp parallel num_threads(num_threads) reduction(+: total_count)
+    {
+        uint64_t B[256];
+        std::memcpy(B, B_global, sizeof(B_global));
+
+        int tid = omp_get_thread_num();
+        size_t chunk = (n + num_threads - 1) / num_threads;
+        size_t worker_start = std::min(n, tid * chunk);
+        size_t worker_end = std::min(n, worker_start + chunk);
+        Numa::bindWorker(tid, num_threads);
+        TRACE_SCOPE("shiftor.scan_chunk");
+
+        // Warm the state up on the m - 1 bases before the chunk
+        uint64_t state = ~0ULL;
+        size_t prefix_from = (worker_start >= (m - 1)) ? (worker_start - (m - 1)) : 0;
+        for (size_t k = prefix_from; k < worker_start; ++k)
+            state = (state << 1) | B[(unsigned char)text[k]];
 
-    uint64_t state = ~0ULL;
-    size_t count = 0;
-    for (size_t i = 0; i < n; ++i) {
-        state = (state << 1) | B[(unsigned char)text[i]];
-        if (i >= m - 1 && (state & (1ULL << (m - 1))) == 0)
-            ++count;
+        size_t local_count = 0;
+        for (size_t i = worker_start; i < std::min(n, worker_end + (m - 1)); ++i) {
+            state = (state << 1) | B[(unsigned char)text[i]];
+            if (i >= m - 1 && (state & (1ULL << (m - 1))) == 0) {
+                size_t pos = i - (m - 1);
+                if (pos >= worker_start && pos < worker_end) ++local_count;
+            }
+        }
+        total_count += local_count;
     }
-    return count; 
+    return total_count;
 }
 
 size_t BitParallelShiftOr::searchParallelInFasta(const std::string& pattern, const std::string& fastaPath) const {
     int num_threads = 4;
-    std::string dnaSequence = FastaReader::readSequence(fastaPath);
-    return searchParallel(pattern, dnaSequence, num_threads);
+    auto genome = Genome::load(fastaPath, num_threads);
+    return searchParallel(pattern, genome->view(), num_threads);
 }
 
-size_t BitParallelShiftOr::searchWithReverseComplement(const std::string& pattern, const std::string& text, bool parallel) const {
-    std::string rc_pattern = BioUtils::reverseComplement(pattern);
+size_t BitParallelShiftOr::searchWithReverseComplement(std::string_view pattern, std::string_view text, bool parallel) const {
+    TRACE_SCOPE("shiftor.search_rc");
+    Arena::Scope scratch;
+    std::pmr::string rc_pattern = BioUtils::reverseComplement(pattern, scratch.resource());
     
     if (parallel) {
         int num_threads = 4;
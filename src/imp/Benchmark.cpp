@@ -1,6 +1,9 @@
 #include "../../include/Benchmark.hpp"
 #include "../../include/HybridPicker.hpp"
 #include "../../include/FastaReader.hpp"
+#include "../../include/Genome.hpp"
+#include "../../include/KMP.hpp"
+#include "../../include/Numa.hpp"
 
 #include <string>
 #include <iostream>
@@ -57,11 +60,35 @@ void Benchmark::run(const std::string& pattern, const std::string& fastaPath) {
     benchmarkAlgorithm("bmh", pattern, fastaPath, false);
     benchmarkAlgorithm("kmp", pattern, fastaPath, false);
     benchmarkAlgorithm("bithiftor", pattern, fastaPath, false);
+    benchmarkAlgorithm("bndm", pattern, fastaPath, false);
+    benchmarkAlgorithm("qbmh", pattern, fastaPath, false);
 
     std::cout << "Parallel: " << std::endl;
     benchmarkAlgorithm("bmh", pattern, fastaPath, true);
     benchmarkAlgorithm("kmp", pattern, fastaPath, true);
     benchmarkAlgorithm("bithiftor", pattern, fastaPath, true);
+    benchmarkAlgorithm("bndm", pattern, fastaPath, true);
+    benchmarkAlgorithm("qbmh", pattern, fastaPath, true);
+
+    {
+        auto start = std::chrono::steady_clock::now();
+        size_t matches = picker.autoPickAndSearchAdaptive(pattern, fastaPath);
+        auto end = std::chrono::steady_clock::now();
+        auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+        std::cout << "Algorithm: adaptive (Parallel, per region)"
+                << ", Matches: " << matches
+                << ", Time: " << duration << " µs\n";
+    }
+
+    {
+        auto start = std::chrono::steady_clock::now();
+        size_t matches = picker.autoPickAndSearchIndexed(pattern, fastaPath);
+        auto end = std::chrono::steady_clock::now();
+        auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+        std::cout << "Algorithm: indexed (minimizer seeds, includes index load/build)"
+                << ", Matches: " << matches
+                << ", Time: " << duration << " µs\n";
+    }
 
 
     std::cout << "\n=== BIOLOGICAL SEARCH (WITH REVERSE COMPLEMENT) ===" << std::endl;
@@ -69,12 +96,17 @@ void Benchmark::run(const std::string& pattern, const std::string& fastaPath) {
     benchmarkAlgorithmWithReverseComplement("bmh", pattern, fastaPath, false);
     benchmarkAlgorithmWithReverseComplement("kmp", pattern, fastaPath, false);
     benchmarkAlgorithmWithReverseComplement("bithiftor", pattern, fastaPath, false);
+    benchmarkAlgorithmWithReverseComplement("bndm", pattern, fastaPath, false);
+    benchmarkAlgorithmWithReverseComplement("qbmh", pattern, fastaPath, false);
 
     std::cout << "Parallel: " << std::endl;
     benchmarkAlgorithmWithReverseComplement("bmh", pattern, fastaPath, true);
     benchmarkAlgorithmWithReverseComplement("kmp", pattern, fastaPath, true);
     benchmarkAlgorithmWithReverseComplement("bithiftor", pattern, fastaPath, true);
+    benchmarkAlgorithmWithReverseComplement("bndm", pattern, fastaPath, true);
+    benchmarkAlgorithmWithReverseComplement("qbmh", pattern, fastaPath, true);
 
+    runPlacement(pattern, fastaPath);
     
 
     // HybridPicker picker;
@@ -89,3 +121,34 @@ void Benchmark::run(const std::string& pattern, const std::string& fastaPath) {
     // std::cout << "Bit-Parallel Shift-Or Matches: " << bpMatches << "\n";
 
 }
+
+void Benchmark::runPlacement(const std::string& pattern, const std::string& fastaPath, int num_threads) {
+    // KMP reads every base, so the scan is bound by where the pages live
+    KMP kmp;
+    const Numa::Binding saved = Numa::binding();
+
+    std::cout << "\n=== NUMA PLACEMENT (kmp, " << num_threads << " threads, "
+              << Numa::nodeCount() << " node(s)) ===" << std::endl;
+    for (Numa::Binding b : {Numa::Binding::Off, Numa::Binding::Local, Numa::Binding::Remote}) {
+        Numa::setBinding(b);
+        // Reload so the first touch follows this policy
+        auto genome = Genome::load(fastaPath, num_threads);
+
+        long long best = -1;
+        size_t matches = 0;
+        for (int rep = 0; rep < 3; ++rep) {
+            auto start = std::chrono::steady_clock::now();
+            matches = kmp.searchParallel(pattern, genome->view(), num_threads);
+            auto end = std::chrono::steady_clock::now();
+            long long us = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+            if (best < 0 || us < best) best = us;
+        }
+        std::cout << "Workers: " << Numa::bindingName(b)
+                << ", Pages: " << genome->buffer().pagesName()
+                << ", Matches: " << matches
+                << ", Time: " << best << " µs\n";
+    }
+    Numa::setBinding(saved);
+    // The Local / Remote passes pinned the main thread and the pool; later searches must not inherit that
+    Numa::restoreAffinity();
+}
@@ -0,0 +1,218 @@
+#include "../../include/BioUtils.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <omp.h>
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+// Below this many bytes a single thread is faster than waking the team
+static constexpr size_t PARALLEL_MIN_BYTES = 1 << 22; // 4M
+
+namespace {
+
+#ifdef __AVX2__
+    inline __m256i complement32(__m256i v) {
+        // OR-ing 0x20 lower-cases letters, so one compare per base covers both cases
+        const __m256i lower = _mm256_or_si256(v, _mm256_set1_epi8(0x20));
+        const __m256i at = _mm256_or_si256(_mm256_cmpeq_epi8(lower, _mm256_set1_epi8('a')),
+                                           _mm256_cmpeq_epi8(lower, _mm256_set1_epi8('t')));
+        const __m256i cg = _mm256_or_si256(_mm256_cmpeq_epi8(lower, _mm256_set1_epi8('c')),
+                                           _mm256_cmpeq_epi8(lower, _mm256_set1_epi8('g')));
+        // A^T == 0x15 and C^G == 0x04 in both cases; everything else is left alone
+        const __m256i flip = _mm256_or_si256(_mm256_and_si256(at, _mm256_set1_epi8(0x15)),
+                                             _mm256_and_si256(cg, _mm256_set1_epi8(0x04)));
+        return _mm256_xor_si256(v, flip);
+    }
+
+    inline __m256i reverse32(__m256i v) {
+        const __m256i rev = _mm256_setr_epi8(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0,
+                                             15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+        v = _mm256_shuffle_epi8(v, rev);
+        return _mm256_permute2x128_si256(v, v, 1);
+    }
+
+    inline __m256i load32(const char* p) {
+        return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    }
+
+    inline void store32(char* p, __m256i v) {
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v);
+    }
+
+    inline uint32_t matchMask(__m256i v, char c) {
+        return static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(c))));
+    }
+#endif
+
+    // dst[i] = complement(src[n - 1 - i]) for i in [from, to)
+    void reverseComplementRange(const char* src, size_t n, char* dst, size_t from, size_t to) {
+        size_t i = from;
+#ifdef __AVX2__
+        for (; i + 32 <= to; i += 32)
+            store32(dst + i, reverse32(complement32(load32(src + n - i - 32))));
+#endif
+        for (; i < to; ++i)
+            dst[i] = BioUtils::complementBase(src[n - 1 - i]);
+    }
+
+    // Swaps-and-complements s[i] with s[n - 1 - i] for i in [from, to), to <= n / 2
+    void reverseComplementPairs(char* s, size_t n, size_t from, size_t to) {
+        size_t i = from;
+#ifdef __AVX2__
+        for (; i + 32 <= to; i += 32) {
+            __m256i left = load32(s + i);
+            __m256i right = load32(s + n - i - 32);
+            store32(s + i, reverse32(complement32(right)));
+            store32(s + n - i - 32, reverse32(complement32(left)));
+        }
+#endif
+        for (; i < to; ++i) {
+            char left = s[i];
+            s[i] = BioUtils::complementBase(s[n - 1 - i]);
+            s[n - 1 - i] = BioUtils::complementBase(left);
+        }
+    }
+
+    void toUpperRange(const char* src, char* dst, size_t from, size_t to) {
+        size_t i = from;
+#ifdef __AVX2__
+        const __m256i below = _mm256_set1_epi8('a' - 1);
+        const __m256i above = _mm256_set1_epi8('z' + 1);
+        const __m256i bit = _mm256_set1_epi8(0x20);
+        for (; i + 32 <= to; i += 32) {
+            __m256i v = load32(src + i);
+            // Signed compares keep bytes >= 0x80 out of the a..z range
+            __m256i is_lower = _mm256_and_si256(_mm256_cmpgt_epi8(v, below), _mm256_cmpgt_epi8(above, v));
+            store32(dst + i, _mm256_sub_epi8(v, _mm256_and_si256(is_lower, bit)));
+        }
+#endif
+        for (; i < to; ++i) {
+            char c = src[i];
+            dst[i] = (c >= 'a' && c <= 'z') ? static_cast<char>(c - 0x20) : c;
+        }
+    }
+
+    int threadsFor(size_t n) {
+        return n < PARALLEL_MIN_BYTES ? 1 : omp_get_max_threads();
+    }
+
+    // Splits [0, n) into num_threads contiguous ranges aligned to 32 bytes
+    template <typename Body>
+    void forEachRange(size_t n, Body body) {
+        const int num_threads = threadsFor(n);
+        if (num_threads == 1) {
+            body(size_t{0}, n);
+            return;
+        }
+        #pragma omp parallel num_threads(num_threads)
+        {
+            int tid = omp_get_thread_num();
+            size_t chunk = ((n + num_threads - 1) / num_threads + 31) & ~size_t{31};
+            size_t from = std::min(n, tid * chunk);
+            size_t to = std::min(n, from + chunk);
+            if (from < to) body(from, to);
+        }
+    }
+}
+
+namespace BioUtils {
+
+    BaseCounts countBases(std::string_view dna) {
+        BaseCounts counts;
+        const char* p = dna.data();
+        const size_t n = dna.size();
+        size_t i = 0;
+#ifdef __AVX2__
+        const __m256i bit = _mm256_set1_epi8(0x20);
+        for (; i + 32 <= n; i += 32) {
+            __m256i lower = _mm256_or_si256(load32(p + i), bit);
+            counts.a += std::popcount(matchMask(lower, 'a'));
+            counts.c += std::popcount(matchMask(lower, 'c'));
+            counts.g += std::popcount(matchMask(lower, 'g'));
+            counts.t += std::popcount(matchMask(lower, 't'));
+        }
+#endif
+        for (; i < n; ++i) {
+            switch (p[i] | 0x20) {
+                case 'a': ++counts.a; break;
+                case 'c': ++counts.c; break;
+                case 'g': ++counts.g; break;
+                case 't': ++counts.t; break;
+                default: break;
+            }
+        }
+        return counts;
+    }
+
+    void reverseComplementInto(const char* src, size_t n, char* dst) {
+        forEachRange(n, [&](size_t from, size_t to) {
+            reverseComplementRange(src, n, dst, from, to);
+        });
+    }
+
+    void reverseComplementInPlace(std::string& dna) {
+        const size_t n = dna.size();
+        const size_t half = n / 2;
+        char* s = dna.data();
+        forEachRange(half, [&](size_t from, size_t to) {
+            reverseComplementPairs(s, n, from, to);
+        });
+        if (n % 2 == 1) s[half] = complementBase(s[half]);
+    }
+
+    void toUpperCaseInto(const char* src, size_t n, char* dst) {
+        forEachRange(n, [&](size_t from, size_t to) {
+            toUpperRange(src, dst, from, to);
+        });
+    }
+
+    std::vector<BaseCounts> windowedBaseCounts(std::string_view dna, size_t window, size_t step, int num_threads) {
+        const size_t n = dna.size();
+        if (window == 0 || step == 0 || n < window) return {};
+        if (num_threads <= 0) num_threads = 1;
+
+        const size_t windows = (n - window) / step + 1;
+        std::vector<BaseCounts> result(windows);
+        if (windows * window < PARALLEL_MIN_BYTES) num_threads = 1;
+
+        #pragma omp parallel num_threads(num_threads)
+        {
+            int tid = omp_get_thread_num();
+            int team = omp_get_num_threads();
+            size_t chunk = (windows + team - 1) / team;
+            size_t first = std::min(windows, tid * chunk);
+            size_t last = std::min(windows, first + chunk);
+
+            BaseCounts counts;
+            for (size_t w = first; w < last; ++w) {
+                size_t start = w * step;
+                if (w == first || step >= window) {
+                    counts = countBases(dna.substr(start, window));
+                } else {
+                    // Slide: drop the bases that left, add the ones that entered
+                    counts -= countBases(dna.substr(start - step, step));
+                    counts += countBases(dna.substr(start + window - step, step));
+                }
+                result[w] = counts;
+            }
+        }
+        return result;
+    }
+
+    std::vector<double> windowedGCContent(std::string_view dna, size_t window, size_t step, int num_threads) {
+        std::vector<BaseCounts> counts = windowedBaseCounts(dna, window, step, num_threads);
+        std::vector<double> gc(counts.size());
+        std::transform(counts.begin(), counts.end(), gc.begin(), gcContent);
+        return gc;
+    }
+
+    std::vector<double> windowedShannonEntropy(std::string_view dna, size_t window, size_t step, int num_threads) {
+        std::vector<BaseCounts> counts = windowedBaseCounts(dna, window, step, num_threads);
+        std::vector<double> entropy(counts.size());
+        std::transform(counts.begin(), counts.end(), entropy.begin(), shannonEntropy);
+        return entropy;
+    }
+}
@@ -0,0 +1,272 @@
+#include "../../include/Calibration.hpp"
+#include "../../include/BM.hpp"
+#include "../../include/BNDM.hpp"
+#include "../../include/BP.hpp"
+#include "../../include/KMP.hpp"
+#include "../../include/QGramBMH.hpp"
+#include "../../include/Trace.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <omp.h>
+
+using namespace std;
+
+namespace {
+
+    constexpr int FORMAT_VERSION = 1;
+    constexpr size_t MIN_CHUNK_FLOOR = 4096;
+    // A chunk must take this many fork/join costs to scan, keeping the overhead near 5%
+    constexpr double CHUNK_OVERHEAD_FACTOR = 20;
+    constexpr size_t PRIMER_LENGTH = 32;
+    constexpr int REPEATS = 3;
+
+    vector<unique_ptr<PatternMatcher>> engines() {
+        vector<unique_ptr<PatternMatcher>> all;
+        all.push_back(make_unique<BoyerMooreHorspool>());
+        all.push_back(make_unique<KMP>());
+        all.push_back(make_unique<BitParallelShiftOr>());
+        all.push_back(make_unique<BNDM>());
+        all.push_back(make_unique<QGramBMH>());
+        return all;
+    }
+
+    template <typename Fn>
+    double bestSeconds(Fn&& fn) {
+        double best = 1e30;
+        for (int r = 0; r < REPEATS; ++r) {
+            auto t0 = chrono::steady_clock::now();
+            fn();
+            auto t1 = chrono::steady_clock::now();
+            best = std::min(best, chrono::duration<double>(t1 - t0).count());
+        }
+        return std::max(best, 1e-9);
+    }
+
+    // Full-width sum over the buffer, chunked like the matchers
+    double streamingBandwidth(const string& text, int threads) {
+        const size_t words = text.size() / sizeof(uint64_t);
+        volatile uint64_t sink = 0;
+        double secs = bestSeconds([&] {
+            uint64_t total = 0;
+            #pragma omp parallel num_threads(threads) reduction(+: total)
+            {
+                int tid = omp_get_thread_num();
+                size_t chunk = (words + threads - 1) / threads;
+                size_t worker_start = std::min(words, tid * chunk);
+                size_t worker_end = std::min(words, worker_start + chunk);
+                uint64_t local = 0;
+                for (size_t i = worker_start; i < worker_end; ++i) {
+                    uint64_t w;
+                    memcpy(&w, text.data() + i * sizeof(uint64_t), sizeof(w));
+                    local += w;
+                }
+                total += local;
+            }
+            sink = sink + total;
+        });
+        return static_cast<double>(words * sizeof(uint64_t)) / secs;
+    }
+
+    double forkJoinSeconds(int threads) {
+        constexpr int REGIONS = 200;
+        double secs = bestSeconds([&] {
+            for (int r = 0; r < REGIONS; ++r) {
+                #pragma omp parallel num_threads(threads)
+                {
+                    asm volatile("" ::: "memory");
+                }
+            }
+        });
+        return secs / REGIONS;
+    }
+
+    bool recalibrationForced() {
+        const char* env = getenv("DNASEQ_CALIBRATE");
+        return env && string(env) == "force";
+    }
+
+    bool calibrationRequested() {
+        const char* env = getenv("DNASEQ_CALIBRATE");
+        return env && *env && string(env) != "0";
+    }
+
+    Calibration::Profile initialProfile() {
+        const string path = Calibration::defaultPath();
+        if (!recalibrationForced()) {
+            auto stored = Calibration::load(path);
+            if (stored && stored->hardware_threads == omp_get_num_procs()) return *stored;
+        }
+        if (!calibrationRequested()) return {};
+        Calibration::Profile measured = Calibration::measure();
+        Calibration::save(measured, path);
+        return measured;
+    }
+
+    // Searches read the profile on every parallel call, so the read is a single acquire
+    // load. Replaced profiles stay alive: setCurrent is rare and a reader may still hold
+    // a reference to the one it loaded
+    struct State {
+        mutex lock;
+        vector<unique_ptr<const Calibration::Profile>> kept;
+        atomic<const Calibration::Profile*> profile{nullptr};
+    };
+
+    State& state() {
+        static State s;
+        return s;
+    }
+
+    // Caller holds s.lock
+    const Calibration::Profile& publish(State& s, Calibration::Profile profile) {
+        s.kept.push_back(make_unique<const Calibration::Profile>(std::move(profile)));
+        s.profile.store(s.kept.back().get(), memory_order_release);
+        return *s.kept.back();
+    }
+
+    const Calibration::Profile& active() {
+        State& s = state();
+        if (const Calibration::Profile* p = s.profile.load(memory_order_acquire)) return *p;
+        lock_guard<mutex> guard(s.lock);
+        if (const Calibration::Profile* p = s.profile.load(memory_order_relaxed)) return *p;
+        return publish(s, initialProfile());
+    }
+}
+
+namespace Calibration {
+
+    size_t Profile::minChunk(string_view engine) const {
+        auto it = engines.find(engine);
+        return it == engines.end() ? DEFAULT_MIN_CHUNK : std::max<size_t>(1, it->second.min_chunk);
+    }
+
+    int Profile::threadsFor(string_view engine, size_t n, int requested) const {
+        size_t threads = requested <= 0 ? 1 : static_cast<size_t>(requested);
+        threads = std::min(threads, std::max<size_t>(1, n / minChunk(engine)));
+        if (hardware_threads > 0) threads = std::min(threads, static_cast<size_t>(hardware_threads));
+
+        // Past bandwidth / rate workers, more threads only queue on memory
+        auto it = engines.find(engine);
+        if (bandwidth > 0 && it != engines.end() && it->second.bytes_per_second > 0) {
+            double saturating = std::ceil(bandwidth / it->second.bytes_per_second);
+            threads = std::min(threads, static_cast<size_t>(std::max(1.0, saturating)));
+        }
+        return static_cast<int>(threads);
+    }
+
+    Profile measure(size_t text_bytes) {
+        TRACE_SCOPE("calibration.measure");
+        text_bytes = std::max(text_bytes, size_t{1} << 16);
+        mt19937_64 rng(42);
+        string text(text_bytes, 'A');
+        for (char& c : text) c = "ACGT"[rng() & 3];
+        const string_view primer = string_view(text).substr(text.size() / 2, PRIMER_LENGTH);
+
+        Profile p;
+        p.hardware_threads = std::max(1, omp_get_num_procs());
+        p.bandwidth = streamingBandwidth(text, p.hardware_threads);
+        p.fork_join_seconds = forkJoinSeconds(p.hardware_threads);
+
+        for (const auto& matcher : engines()) {
+            volatile size_t sink = 0;
+            double secs = bestSeconds([&] { sink = sink + matcher->search(primer, text); });
+
+            EngineRate rate;
+            rate.bytes_per_second = static_cast<double>(text.size()) / secs;
+            size_t chunk = static_cast<size_t>(rate.bytes_per_second * p.fork_join_seconds * CHUNK_OVERHEAD_FACTOR);
+            chunk = (chunk + MIN_CHUNK_FLOOR - 1) / MIN_CHUNK_FLOOR * MIN_CHUNK_FLOOR;
+            rate.min_chunk = std::max(chunk, MIN_CHUNK_FLOOR);
+            p.engines[string(matcher->name())] = rate;
+        }
+        return p;
+    }
+
+    bool save(const Profile& profile, const string& path) {
+        error_code ec;
+        const filesystem::path parent = filesystem::path(path).parent_path();
+        if (!parent.empty()) filesystem::create_directories(parent, ec);
+
+        const string temp = path + ".tmp";
+        {
+            ofstream out(temp, ios::trunc);
+            if (!out) return false;
+            out.precision(17);
+            out << "dnaseq_calibration " << FORMAT_VERSION << '\n'
+                << "hardware_threads " << profile.hardware_threads << '\n'
+                << "bandwidth " << profile.bandwidth << '\n'
+                << "fork_join_seconds " << profile.fork_join_seconds << '\n';
+            for (const auto& [name, rate] : profile.engines)
+                out << "engine " << name << ' ' << rate.bytes_per_second << ' ' << rate.min_chunk << '\n';
+            if (!out) {
+                remove(temp.c_str());
+                return false;
+            }
+        }
+        if (rename(temp.c_str(), path.c_str()) != 0) {
+            remove(temp.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    optional<Profile> load(const string& path) {
+        ifstream in(path);
+        if (!in) return nullopt;
+
+        string key;
+        int version = 0;
+        if (!(in >> key >> version) || key != "dnaseq_calibration" || version != FORMAT_VERSION) return nullopt;
+
+        Profile p;
+        for (string line; getline(in, line);) {
+            istringstream fields(line);
+            if (!(fields >> key)) continue;
+            bool ok = true;
+            if (key == "hardware_threads") ok = static_cast<bool>(fields >> p.hardware_threads);
+            else if (key == "bandwidth") ok = static_cast<bool>(fields >> p.bandwidth);
+            else if (key == "fork_join_seconds") ok = static_cast<bool>(fields >> p.fork_join_seconds);
+            else if (key == "engine") {
+                string name;
+                EngineRate rate;
+                ok = static_cast<bool>(fields >> name >> rate.bytes_per_second >> rate.min_chunk);
+                if (ok) p.engines[name] = rate;
+            }
+            if (!ok) return nullopt;
+        }
+        if (!p.calibrated()) return nullopt;
+        return p;
+    }
+
+    string defaultPath() {
+        if (const char* env = getenv("DNASEQ_CALIBRATION"); env && *env) return env;
+        const char* home = getenv("HOME");
+        return string(home && *home ? home : ".") + "/.cache/dnaseq_calibration.txt";
+    }
+
+    const Profile& current() {
+        return active();
+    }
+
+    void setCurrent(Profile profile) {
+        State& s = state();
+        lock_guard<mutex> guard(s.lock);
+        publish(s, std::move(profile));
+    }
+
+    int threadsFor(string_view engine, size_t n, int requested) {
+        return active().threadsFor(engine, n, requested);
+    }
+}
@@ -0,0 +1,51 @@
+#include "../../include/CompiledPattern.hpp"
+#include "../../include/BM.hpp"
+#include "../../include/BNDM.hpp"
+#include "../../include/BP.hpp"
+#include "../../include/BioUtils.hpp"
+#include "../../include/KMP.hpp"
+#include "../../include/QGramBMH.hpp"
+#include "../../include/Trace.hpp"
+
+#include <algorithm>
+#include <iterator>
+
+using namespace std;
+
+shared_ptr<const CompiledPattern> CompiledPattern::compile(string_view pattern) {
+    TRACE_SCOPE("compiled.build");
+    shared_ptr<CompiledPattern> compiled(new CompiledPattern());
+    build(pattern, compiled->fwd);
+    build(BioUtils::reverseComplement(pattern), compiled->rev);
+    return compiled;
+}
+
+void CompiledPattern::build(string_view bases, CompiledStrand& out) {
+    const size_t m = bases.size();
+    out.bases.assign(bases);
+
+    // Word-sized engines only apply up to 64 bases; the oracle takes over past that
+    if (m <= BNDM::MAX_BNDM_LENGTH) {
+        BitParallelShiftOr::buildMasks(bases, out.shift_or);
+        BNDM::buildMasks(bases, out.bndm);
+        fill(begin(out.oracle_code), end(out.oracle_code), 0);
+    } else {
+        fill(begin(out.shift_or), end(out.shift_or), ~0ULL);
+        fill(begin(out.bndm), end(out.bndm), 0);
+        out.oracle_sigma = static_cast<uint32_t>(BNDM::buildOracleAlphabet(bases, out.oracle_code));
+        out.oracle_next.resize((m + 1) * out.oracle_sigma);
+        vector<int32_t> supply(m + 1);
+        BNDM::buildOracle(bases, out.oracle_code, out.oracle_sigma, out.oracle_next.data(), supply.data());
+    }
+
+    BoyerMooreHorspool::buildBadCharTable(bases, out.bad_char);
+
+    out.lps.resize(m);
+    KMP::buildLPS(bases, out.lps.data());
+
+    out.q = static_cast<uint32_t>(QGramBMH::chooseQ(m));
+    if (out.q != 0) {
+        out.qgram_shift.resize(QGramBMH::shiftTableSize(out.q));
+        QGramBMH::buildShiftTable(bases, out.q, out.qgram_shift.data());
+    }
+}
@@ -0,0 +1,104 @@
+#include "../../include/CompositionProfile.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <omp.h>
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+using namespace std;
+
+// Counts positions i in [p, n) with s[i] == s[i - p]
+static size_t countPeriodMatches(const char* s, size_t n, size_t p) {
+    size_t count = 0;
+    size_t i = p;
+#ifdef __AVX2__
+    for (; i + 32 <= n; i += 32) {
+        __m256i cur = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + i));
+        __m256i back = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + i - p));
+        count += popcount(static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(cur, back))));
+    }
+#endif
+    for (; i < n; ++i)
+        count += (s[i] == s[i - p]);
+    return count;
+}
+
+static double periodDensity(const char* s, size_t n, size_t p) {
+    if (n <= p) return 0.0;
+    return static_cast<double>(countPeriodMatches(s, n, p)) / (n - p);
+}
+
+RegionComposition CompositionProfile::profileRegion(string_view text, size_t start, size_t length) {
+    RegionComposition r;
+    start = min(start, text.size());
+    length = min(length, text.size() - start);
+    const char* s = text.data() + start;
+
+    r.start = start;
+    r.length = length;
+    r.counts = BioUtils::countBases(text.substr(start, length));
+    r.gc_content = BioUtils::gcContent(r.counts);
+    r.entropy = BioUtils::shannonEntropy(r.counts);
+    r.homopolymer_density = periodDensity(s, length, 1);
+    r.repeat_density = max({periodDensity(s, length, 2),
+                            periodDensity(s, length, 3),
+                            periodDensity(s, length, 4)});
+    return r;
+}
+
+CompositionProfile CompositionProfile::compute(string_view text, size_t window, int num_threads) {
+    CompositionProfile profile;
+    if (window == 0) window = DEFAULT_WINDOW;
+    if (num_threads <= 0) num_threads = 1;
+
+    const size_t n = text.size();
+    const size_t count = (n + window - 1) / window;
+    profile.window = window;
+    profile.text_length = n;
+    profile.tiles.resize(count);
+
+    #pragma omp parallel for num_threads(num_threads) schedule(static)
+    for (size_t w = 0; w < count; ++w)
+        profile.tiles[w] = profileRegion(text, w * window, window);
+
+    return profile;
+}
+
+const RegionComposition& CompositionProfile::at(size_t pos) const {
+    // Empty text: no tile to clamp to
+    static const RegionComposition EMPTY;
+    if (tiles.empty()) return EMPTY;
+    size_t w = min(pos / window, tiles.size() - 1);
+    return tiles[w];
+}
+
+RegionComposition CompositionProfile::summarize(size_t begin, size_t end) const {
+    RegionComposition r;
+    end = min(end, text_length);
+    if (tiles.empty() || begin >= end) return r;
+
+    size_t first = begin / window;
+    size_t last = (end - 1) / window;
+    double weight = 0.0;
+    for (size_t w = first; w <= last; ++w) {
+        const RegionComposition& t = tiles[w];
+        double len = static_cast<double>(t.length);
+        r.counts += t.counts;
+        r.homopolymer_density += t.homopolymer_density * len;
+        r.repeat_density += t.repeat_density * len;
+        weight += len;
+    }
+
+    r.start = tiles[first].start;
+    r.length = tiles[last].start + tiles[last].length - r.start;
+    r.gc_content = BioUtils::gcContent(r.counts);
+    r.entropy = BioUtils::shannonEntropy(r.counts);
+    if (weight > 0) {
+        r.homopolymer_density /= weight;
+        r.repeat_density /= weight;
+    }
+    return r;
+}
@@ -1,26 +1,121 @@
 #include "../../include/FastaReader.hpp"
+#include "../../include/Trace.hpp"
 
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <fstream>
 #include <iostream>
+#include <string_view>
 
 using namespace std;
 
+namespace {
+
+    // Appends a sequence line's bases, upper-cased, dropping anything but A/C/G/T/N
+    void appendBases(const string& line, string& out) {
+        for (char c : line) {
+            if (c != '\r' && c != '\n') {
+                c = toupper(static_cast<unsigned char>(c));
+                if (c == 'A' || c == 'C' || c == 'G' || c == 'T' || c == 'N')
+                    out.push_back(c);
+            }
+        }
+    }
+
+    ifstream openOrExit(const string& fastaPath) {
+        ifstream f(fastaPath);
+        if (!f) {
+            cerr << "Error: cannot open " << fastaPath << "\n";
+            exit(1);
+        }
+        return f;
+    }
+
+    /**
+     * Streams the sequence lines, handing each line's bases and their offset in
+     * the concatenated sequence to visit; stops early when visit returns false
+     */
+    template <typename Visit>
+    void streamBases(const string& fastaPath, Visit visit) {
+        ifstream f = openOrExit(fastaPath);
+        string buf, bases;
+        size_t offset = 0;
+        while (getline(f, buf)) {
+            if (!buf.empty() && buf[0] == '>') continue;
+            bases.clear();
+            appendBases(buf, bases);
+            if (!visit(string_view(bases), offset)) return;
+            offset += bases.size();
+        }
+    }
+}
+
 string FastaReader::readSequence(const string& fastaPath) {
-      std::ifstream f(fastaPath);
-    if (!f) {
-        std::cerr << "Error: cannot open " << fastaPath << "\n";
-        std::exit(1);
+    TRACE_SCOPE("fasta.read");
+    if (auto cache = GenomeCache::open(fastaPath)) {
+        string seq(cache->size(), 'N');
+        cache->decode(seq.data(), 0, seq.size());
+        return seq;
     }
+    vector<GenomeCache::Record> records;
+    string seq = parseSequence(fastaPath, &records);
+    // Best effort: a read-only directory just means parsing again next time
+    GenomeCache::write(fastaPath, seq, records);
+    return seq;
+}
+
+string FastaReader::parseSequence(const string& fastaPath, vector<GenomeCache::Record>* records) {
+    TRACE_SCOPE("fasta.parse");
+    std::ifstream f = openOrExit(fastaPath);
     std::string buf, seq;
     seq.reserve(10'000'000);
+    auto closeRecord = [&]() {
+        if (records && !records->empty()) records->back().length = seq.size() - records->back().offset;
+    };
     while (std::getline(f, buf)) {
-        if (!buf.empty() && buf[0] == '>') continue;
-        for (char c : buf) {
-            if (c != '\r' && c != '\n') {
-                c = std::toupper(static_cast<unsigned char>(c));
-                if (c == 'A' || c == 'C' || c == 'G' || c == 'T' || c == 'N')
-                    seq.push_back(c);
+        if (!buf.empty() && buf[0] == '>') {
+            closeRecord();
+            if (records) {
+                std::string name = buf.substr(1);
+                if (!name.empty() && name.back() == '\r') name.pop_back();
+                records->push_back({name, seq.size(), 0});
             }
+            continue;
         }
+        // Bases before any header form an unnamed record
+        if (records && records->empty() && !buf.empty()) records->push_back({"", seq.size(), 0});
+        appendBases(buf, seq);
     }
+    closeRecord();
     return seq;
-}
\ No newline at end of file
+}
+
+string FastaReader::readRange(const string& fastaPath, size_t begin, size_t end) {
+    TRACE_SCOPE("fasta.read_range");
+    if (auto cache = GenomeCache::open(fastaPath)) {
+        end = std::min(end, cache->size());
+        if (begin >= end) return {};
+        string seq(end - begin, 'N');
+        cache->decode(seq.data(), begin, end);
+        return seq;
+    }
+    string seq;
+    if (begin >= end) return seq;
+    streamBases(fastaPath, [&](string_view bases, size_t offset) {
+        const size_t from = std::max(begin, offset), to = std::min(end, offset + bases.size());
+        if (from < to) seq.append(bases.substr(from - offset, to - from));
+        return offset + bases.size() < end;
+    });
+    return seq;
+}
+
+size_t FastaReader::sequenceLength(const string& fastaPath) {
+    if (auto cache = GenomeCache::open(fastaPath)) return cache->size();
+    size_t total = 0;
+    streamBases(fastaPath, [&](string_view bases, size_t) {
+        total += bases.size();
+        return true;
+    });
+    return total;
+}
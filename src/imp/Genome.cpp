@@ -0,0 +1,72 @@
+#include "../../include/Genome.hpp"
+#include "../../include/FastaReader.hpp"
+#include "../../include/GenomeCache.hpp"
+#include "../../include/Trace.hpp"
+
+#include <omp.h>
+#include <stdexcept>
+#include <utility>
+
+using namespace std;
+
+Genome::Genome(string_view sequence, string source, int num_threads)
+    : seq(SequenceBuffer::copyOf(sequence, num_threads)), src(std::move(source)) {}
+
+Genome::Genome(SequenceBuffer buffer, string source)
+    : seq(std::move(buffer)), src(std::move(source)) {}
+
+shared_ptr<const Genome> Genome::load(const string& fastaPath, int num_threads) {
+    TRACE_SCOPE("genome.load");
+    if (auto cache = GenomeCache::open(fastaPath)) {
+        const GenomeCache& packed = *cache;
+        SequenceBuffer buffer = SequenceBuffer::fill(packed.size(), num_threads,
+            [&packed](char* dst, size_t begin, size_t end) { packed.decode(dst, begin, end); });
+        return make_shared<const Genome>(std::move(buffer), fastaPath);
+    }
+    // The parsed string is dropped once its bases are placed in the buffer
+    return make_shared<const Genome>(FastaReader::readSequence(fastaPath), fastaPath, num_threads);
+}
+
+const CompositionProfile& Genome::profile(size_t window) const {
+    TRACE_SCOPE("genome.profile");
+    if (window == 0) window = CompositionProfile::DEFAULT_WINDOW;
+
+    lock_guard<mutex> lock(profile_mutex);
+    auto it = profiles.find(window);
+    if (it == profiles.end()) {
+        auto computed = make_unique<CompositionProfile>(
+            CompositionProfile::compute(seq.view(), window, omp_get_max_threads()));
+        it = profiles.emplace(window, std::move(computed)).first;
+    }
+    return *it->second;
+}
+
+const MinimizerIndex& Genome::minimizerIndex() const {
+    TRACE_SCOPE("genome.minimizer_index");
+    lock_guard<mutex> lock(index_mutex);
+    if (index) return *index;
+
+    if (!src.empty()) {
+        try {
+            auto cached = make_unique<MinimizerIndex>(MinimizerIndex::load(indexPath(src)));
+            if (cached->matches(seq.view())) {
+                index = std::move(cached);
+                return *index;
+            }
+        } catch (const runtime_error&) {
+            // Missing or stale: rebuild below
+        }
+    }
+
+    index = make_unique<MinimizerIndex>(MinimizerIndex::build(seq.view(), MinimizerIndex::DEFAULT_K,
+                                                              MinimizerIndex::DEFAULT_W,
+                                                              omp_get_max_threads()));
+    if (!src.empty()) {
+        try {
+            index->save(indexPath(src));
+        } catch (const runtime_error&) {
+            // Read-only location: keep the in-memory index
+        }
+    }
+    return *index;
+}
@@ -0,0 +1,301 @@
+#include "../../include/GenomeCache.hpp"
+#include "../../include/Trace.hpp"
+
+#include <algorithm>
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <utility>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace std;
+
+namespace {
+
+    constexpr char MAGIC[8] = {'D', 'N', 'A', 'B', 'I', 'N', '1', '\0'};
+    constexpr uint32_t FORMAT_VERSION = 1;
+    constexpr size_t HEADER_BYTES = 128;
+
+    struct FileHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t reserved;
+        uint64_t source_size;
+        int64_t source_mtime_ns;
+        uint64_t total_bases;
+        uint64_t record_count;
+        uint64_t n_run_count;
+        // Section offsets from the start of the file
+        uint64_t path_offset, path_length;
+        uint64_t records_offset;
+        uint64_t names_offset, names_length;
+        uint64_t n_runs_offset;
+        uint64_t bases_offset;
+        uint64_t file_size;
+    };
+    static_assert(sizeof(FileHeader) <= HEADER_BYTES, "header must fit its reserved block");
+
+    struct RecordEntry {
+        uint64_t name_offset;
+        uint64_t name_length;
+        uint64_t offset;
+        uint64_t length;
+    };
+
+    size_t align8(size_t n) {
+        return (n + 7) & ~size_t{7};
+    }
+
+    // Identity of the FASTA the cache was built from
+    struct SourceStamp {
+        string path;
+        uint64_t size = 0;
+        int64_t mtime_ns = 0;
+    };
+
+    bool stampOf(const string& fastaPath, SourceStamp& stamp) {
+        char resolved[PATH_MAX];
+        struct stat st;
+        if (!realpath(fastaPath.c_str(), resolved) || stat(resolved, &st) != 0) return false;
+        stamp.path = resolved;
+        stamp.size = static_cast<uint64_t>(st.st_size);
+        stamp.mtime_ns = static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000LL + st.st_mtim.tv_nsec;
+        return true;
+    }
+
+    uint8_t packCode(char c) {
+        switch (c) {
+            case 'C': return 1;
+            case 'G': return 2;
+            case 'T': return 3;
+            default: return 0;  // A, and N (restored from the run table)
+        }
+    }
+
+    // Four decoded bases per packed byte
+    struct Unpack {
+        char bases[256][4];
+        Unpack() {
+            const char letters[4] = {'A', 'C', 'G', 'T'};
+            for (int b = 0; b < 256; ++b)
+                for (int k = 0; k < 4; ++k) bases[b][k] = letters[(b >> (2 * k)) & 3];
+        }
+    };
+    const Unpack UNPACK;
+
+    // [offset, offset + length) lies inside [0, limit), without wrapping
+    bool fits(uint64_t offset, uint64_t length, uint64_t limit) {
+        return offset <= limit && length <= limit - offset;
+    }
+
+    // Sections sit exactly where write() puts them (path, records, names, runs, bases)
+    // and every record and N run stays inside its section and the sequence
+    bool layoutValid(const FileHeader& h, const char* base, size_t bytes) {
+        if (h.path_offset != HEADER_BYTES || !fits(h.path_offset, h.path_length, bytes)) return false;
+        if (h.records_offset != h.path_offset + align8(h.path_length)) return false;
+        if (h.records_offset > bytes || h.record_count > (bytes - h.records_offset) / sizeof(RecordEntry)) return false;
+        if (h.names_offset != h.records_offset + h.record_count * sizeof(RecordEntry)) return false;
+        if (!fits(h.names_offset, h.names_length, bytes)) return false;
+        if (h.n_runs_offset != h.names_offset + align8(h.names_length)) return false;
+        if (h.n_runs_offset > bytes || h.n_run_count > (bytes - h.n_runs_offset) / (2 * sizeof(uint64_t))) return false;
+        if (h.bases_offset != h.n_runs_offset + h.n_run_count * 2 * sizeof(uint64_t)) return false;
+        if (h.bases_offset > bytes || h.total_bases > (bytes - h.bases_offset) * 4
+            || (h.total_bases + 3) / 4 != bytes - h.bases_offset) return false;
+
+        for (uint64_t i = 0; i < h.record_count; ++i) {
+            RecordEntry e;
+            memcpy(&e, base + h.records_offset + i * sizeof(RecordEntry), sizeof(e));
+            if (!fits(e.name_offset, e.name_length, h.names_length) || !fits(e.offset, e.length, h.total_bases)) return false;
+        }
+        uint64_t previous_end = 0;
+        for (uint64_t r = 0; r < h.n_run_count; ++r) {
+            uint64_t run[2];
+            memcpy(run, base + h.n_runs_offset + r * sizeof(run), sizeof(run));
+            if (run[0] < previous_end || !fits(run[0], run[1], h.total_bases)) return false;
+            previous_end = run[0] + run[1];
+        }
+        return true;
+    }
+
+    void writePadded(ofstream& out, const void* data, size_t n) {
+        static const char zeros[8] = {};
+        out.write(static_cast<const char*>(data), static_cast<streamsize>(n));
+        out.write(zeros, static_cast<streamsize>(align8(n) - n));
+    }
+}
+
+GenomeCache::~GenomeCache() {
+    if (mapping) munmap(mapping, mapping_size);
+}
+
+GenomeCache::GenomeCache(GenomeCache&& other) noexcept {
+    *this = std::move(other);
+}
+
+GenomeCache& GenomeCache::operator=(GenomeCache&& other) noexcept {
+    if (this == &other) return *this;
+    if (mapping) munmap(mapping, mapping_size);
+    mapping = std::exchange(other.mapping, nullptr);
+    mapping_size = std::exchange(other.mapping_size, 0);
+    total_bases = std::exchange(other.total_bases, 0);
+    record_count = std::exchange(other.record_count, 0);
+    packed = std::exchange(other.packed, nullptr);
+    n_runs = std::exchange(other.n_runs, nullptr);
+    n_run_count = std::exchange(other.n_run_count, 0);
+    record_table = std::exchange(other.record_table, nullptr);
+    names = std::exchange(other.names, nullptr);
+    return *this;
+}
+
+bool GenomeCache::write(const string& fastaPath, string_view sequence, const vector<Record>& records) {
+    TRACE_SCOPE("fasta.cache_write");
+    SourceStamp stamp;
+    if (!stampOf(fastaPath, stamp)) return false;
+
+    vector<uint64_t> runs;
+    for (size_t i = 0; i < sequence.size();) {
+        if (sequence[i] != 'N') { ++i; continue; }
+        size_t j = i;
+        while (j < sequence.size() && sequence[j] == 'N') ++j;
+        runs.push_back(i);
+        runs.push_back(j - i);
+        i = j;
+    }
+
+    vector<unsigned char> bases((sequence.size() + 3) / 4, 0);
+    for (size_t i = 0; i < sequence.size(); ++i)
+        bases[i >> 2] |= static_cast<unsigned char>(packCode(sequence[i]) << (2 * (i & 3)));
+
+    vector<RecordEntry> entries;
+    string name_blob;
+    for (const Record& r : records) {
+        entries.push_back({name_blob.size(), r.name.size(), r.offset, r.length});
+        name_blob += r.name;
+    }
+
+    FileHeader h{};
+    memcpy(h.magic, MAGIC, sizeof(MAGIC));
+    h.version = FORMAT_VERSION;
+    h.source_size = stamp.size;
+    h.source_mtime_ns = stamp.mtime_ns;
+    h.total_bases = sequence.size();
+    h.record_count = entries.size();
+    h.n_run_count = runs.size() / 2;
+    h.path_offset = HEADER_BYTES;
+    h.path_length = stamp.path.size();
+    h.records_offset = h.path_offset + align8(h.path_length);
+    h.names_offset = h.records_offset + entries.size() * sizeof(RecordEntry);
+    h.names_length = name_blob.size();
+    h.n_runs_offset = h.names_offset + align8(h.names_length);
+    h.bases_offset = h.n_runs_offset + runs.size() * sizeof(uint64_t);
+    h.file_size = h.bases_offset + bases.size();
+
+    const string target = cachePath(fastaPath);
+    const string temp = target + ".tmp" + to_string(getpid());
+    {
+        ofstream out(temp, ios::binary | ios::trunc);
+        if (!out) return false;
+        char block[HEADER_BYTES] = {};
+        memcpy(block, &h, sizeof(h));
+        out.write(block, sizeof(block));
+        writePadded(out, stamp.path.data(), stamp.path.size());
+        out.write(reinterpret_cast<const char*>(entries.data()), static_cast<streamsize>(entries.size() * sizeof(RecordEntry)));
+        writePadded(out, name_blob.data(), name_blob.size());
+        out.write(reinterpret_cast<const char*>(runs.data()), static_cast<streamsize>(runs.size() * sizeof(uint64_t)));
+        out.write(reinterpret_cast<const char*>(bases.data()), static_cast<streamsize>(bases.size()));
+        if (!out) {
+            remove(temp.c_str());
+            return false;
+        }
+    }
+    if (rename(temp.c_str(), target.c_str()) != 0) {
+        remove(temp.c_str());
+        return false;
+    }
+    return true;
+}
+
+optional<GenomeCache> GenomeCache::open(const string& fastaPath) {
+    TRACE_SCOPE("fasta.cache_open");
+    SourceStamp stamp;
+    if (!stampOf(fastaPath, stamp)) return nullopt;
+
+    int fd = ::open(cachePath(fastaPath).c_str(), O_RDONLY);
+    if (fd < 0) return nullopt;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < HEADER_BYTES) {
+        close(fd);
+        return nullopt;
+    }
+    const size_t bytes = static_cast<size_t>(st.st_size);
+    void* mapped = mmap(nullptr, bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED) return nullopt;
+
+    const char* base = static_cast<const char*>(mapped);
+    FileHeader h;
+    memcpy(&h, base, sizeof(h));
+    const bool valid = memcmp(h.magic, MAGIC, sizeof(MAGIC)) == 0
+        && h.version == FORMAT_VERSION
+        && h.file_size == bytes
+        && h.source_size == stamp.size
+        && h.source_mtime_ns == stamp.mtime_ns
+        && layoutValid(h, base, bytes)
+        && string_view(base + h.path_offset, h.path_length) == stamp.path;
+    if (!valid) {
+        munmap(mapped, bytes);
+        return nullopt;
+    }
+
+    GenomeCache cache;
+    cache.mapping = mapped;
+    cache.mapping_size = bytes;
+    cache.total_bases = h.total_bases;
+    cache.record_count = h.record_count;
+    cache.record_table = base + h.records_offset;
+    cache.names = base + h.names_offset;
+    cache.n_runs = reinterpret_cast<const uint64_t*>(base + h.n_runs_offset);
+    cache.n_run_count = h.n_run_count;
+    cache.packed = reinterpret_cast<const unsigned char*>(base + h.bases_offset);
+    return cache;
+}
+
+vector<GenomeCache::Record> GenomeCache::records() const {
+    vector<Record> out;
+    for (size_t i = 0; i < record_count; ++i) {
+        RecordEntry e;
+        memcpy(&e, record_table + i * sizeof(RecordEntry), sizeof(e));
+        out.push_back({string(names + e.name_offset, e.name_length), e.offset, e.length});
+    }
+    return out;
+}
+
+void GenomeCache::decode(char* out, size_t begin, size_t end) const {
+    TRACE_SCOPE("fasta.cache_decode");
+    end = std::min(end, total_bases);
+    if (begin >= end) return;
+
+    size_t i = begin;
+    // Unaligned head, whole bytes, unaligned tail
+    for (; i < end && (i & 3); ++i) out[i - begin] = UNPACK.bases[packed[i >> 2]][i & 3];
+    for (; i + 4 <= end; i += 4) memcpy(out + (i - begin), UNPACK.bases[packed[i >> 2]], 4);
+    for (; i < end; ++i) out[i - begin] = UNPACK.bases[packed[i >> 2]][i & 3];
+
+    // Runs are sorted by start; begin from the last run starting at or before begin
+    size_t lo = 0, hi = n_run_count;
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        if (n_runs[2 * mid] <= begin) lo = mid + 1;
+        else hi = mid;
+    }
+    for (size_t r = lo > 0 ? lo - 1 : 0; r < n_run_count && n_runs[2 * r] < end; ++r) {
+        size_t from = std::max<size_t>(n_runs[2 * r], begin);
+        size_t to = std::min<size_t>(n_runs[2 * r] + n_runs[2 * r + 1], end);
+        if (from < to) memset(out + (from - begin), 'N', to - from);
+    }
+}
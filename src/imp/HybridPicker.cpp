@@ -1,33 +1,96 @@
 #include "../../include/HybridPicker.hpp"
 #include "../../include/BioUtils.hpp"
+#include "../../include/Calibration.hpp"
+#include "../../include/FastaReader.hpp"
+#include "../../include/Genome.hpp"
+#include "../../include/GenomeCache.hpp"
+#include "../../include/RegionExecutor.hpp"
+#include "../../include/Trace.hpp"
 
 #include <algorithm>
+#include <chrono>
 #include <iostream>
 #include <iomanip>
+#include <cctype>
 #include <cmath>
+#include <numeric>
+#include <optional>
+#include <random>
+#include <utility>
+#include <omp.h>
 
 using namespace std;
 
+// Text regions above these are treated as low-complexity (repeats, poly-A, satellites)
+static constexpr double LOW_COMPLEXITY_ENTROPY = 1.5;
+static constexpr double LOW_COMPLEXITY_HOMOPOLYMER = 0.5;
+static constexpr double LOW_COMPLEXITY_REPEAT = 0.6;
+// Below this expected bad-char shift BMH does more work per base than KMP
+static constexpr double MIN_HORSPOOL_SHIFT = 1.5;
+// BNDM shifts are bounded by m; below this shift-or's flat cost wins
+static constexpr size_t MIN_FACTOR_LENGTH = 16;
+// Long patterns below this entropy: BMH's skips beat BNDM's factor test
+static constexpr double LOW_ENTROPY_PATTERN = 0.7;
+static constexpr size_t LONG_PATTERN = 1000;
+// Below this a scan is cheap enough that building the index for it does not pay off
+static constexpr size_t MIN_INDEXED_LENGTH = 256;
+// Chunks every stratum gets before an estimate may stop; two leave the variance too noisy
+static constexpr size_t SAMPLES_PER_STRATUM = 4;
+
+// Average BMH shift if the last character of each window follows the region's
+// base distribution (shift table of the pattern weighted by text frequencies)
+static double expectedHorspoolShift(const string& pattern, const BioUtils::BaseCounts& counts) {
+    const size_t m = pattern.size();
+    const size_t total = counts.acgt();
+    if (m == 0 || total == 0) return 0.0;
+
+    const pair<char, size_t> bases[] = {{'A', counts.a}, {'C', counts.c}, {'G', counts.g}, {'T', counts.t}};
+    double shift = 0.0;
+    for (auto [base, n] : bases) {
+        size_t s = m;
+        for (size_t i = 0; i + 1 < m; ++i)
+            if (toupper(static_cast<unsigned char>(pattern[i])) == base) s = m - 1 - i;
+        shift += static_cast<double>(n) / total * s;
+    }
+    return shift;
+}
+
+// The training data has no multi-core timings of qbmh yet, so it only replaces the
+// tree's skip engine where this host's calibration (more than one CPU) measured it faster
+static bool qgramMeasuredFaster(const string& algorithm) {
+    if (algorithm != "bmh" && algorithm != "bndm") return false;
+    const Calibration::Profile& profile = Calibration::current();
+    if (profile.hardware_threads <= 1) return false;
+    auto qgram = profile.engines.find("qbmh");
+    auto picked = profile.engines.find(algorithm);
+    return qgram != profile.engines.end() && picked != profile.engines.end() &&
+           qgram->second.bytes_per_second > picked->second.bytes_per_second;
+}
+
 unique_ptr<PatternMatcher> HybridPicker::createMatcher(const string& algorithmName) {
     if (algorithmName == "bmh") return make_unique<BoyerMooreHorspool>();
     if (algorithmName == "kmp") return make_unique<KMP>();
     if (algorithmName == "bithiftor") return make_unique<BitParallelShiftOr>();
+    if (algorithmName == "bndm") return make_unique<BNDM>();
+    if (algorithmName == "qbmh") return make_unique<QGramBMH>();
     return nullptr;
 }
 
 size_t HybridPicker::pickAndSearch(const string& algorithmName, 
                                          const string& pattern, 
                                          const string& fastaPath) {
+    TRACE_SCOPE("picker.search");
     auto matcher = createMatcher(algorithmName);
     if (!matcher) {
         throw invalid_argument("Unknown algorithm: " + algorithmName + 
-                              ". Available: bmh, kmp, bithiftor");
+                              ". Available: bmh, kmp, bithiftor, bndm, qbmh");
     }
     return matcher->searchInFasta(pattern, fastaPath);
 }
 
 size_t HybridPicker::autoPickAndSearch(const string& pattern, 
                                              const string& fastaPath) {
+    TRACE_SCOPE("picker.auto_search");
     string bestAlgorithm = recommendAlgorithm(pattern);
     cout << "Hybrid Picker selected: " << bestAlgorithm << " algorithm" << endl;
     return pickAndSearch(bestAlgorithm, pattern, fastaPath);
@@ -36,62 +99,281 @@ size_t HybridPicker::autoPickAndSearch(const string& pattern,
 size_t HybridPicker::pickAndSearchParallel(const string& algorithmName, 
                                          const string& pattern, 
                                          const string& fastaPath) {
+    TRACE_SCOPE("picker.search_parallel");
     auto matcher = createMatcher(algorithmName);
     if (!matcher) {
         throw invalid_argument("Unknown algorithm: " + algorithmName + 
-                              ". Available: bmh, kmp, bithiftor");
+                              ". Available: bmh, kmp, bithiftor, bndm, qbmh");
     }
     return matcher->searchParallelInFasta(pattern, fastaPath);
 }
 
 size_t HybridPicker::autoPickAndSearchParallel(const string& pattern, 
                                              const string& fastaPath) {
+    TRACE_SCOPE("picker.auto_search_parallel");
     string bestAlgorithm = recommendAlgorithm(pattern);
     cout << "Hybrid Picker selected: " << bestAlgorithm << " algorithm as parallel" << endl;
     return pickAndSearchParallel(bestAlgorithm, pattern, fastaPath);
 }
 
+size_t HybridPicker::autoPickAndSearchAdaptive(const string& pattern,
+                                              const string& fastaPath) {
+    TRACE_SCOPE("picker.auto_search_adaptive");
+    auto genome = Genome::load(fastaPath);
+    RegionExecutor executor;
+    cout << "Hybrid Picker selecting per region as parallel" << endl;
+    return executor.search(pattern, *genome);
+}
+
+size_t HybridPicker::autoPickAndSearchIndexed(const string& pattern,
+                                             const string& fastaPath) {
+    TRACE_SCOPE("picker.auto_search_indexed");
+    auto genome = Genome::load(fastaPath);
+    if (pattern.length() >= MIN_INDEXED_LENGTH) {
+        const MinimizerIndex& index = genome->minimizerIndex();
+        if (index.canAnswer(pattern)) {
+            cout << "Hybrid Picker selected: minimizer index" << endl;
+            return index.count(pattern, genome->view());
+        }
+    }
+    string bestAlgorithm = recommendAlgorithm(pattern);
+    cout << "Hybrid Picker selected: " << bestAlgorithm << " algorithm as parallel" << endl;
+    return createMatcher(bestAlgorithm)->searchParallel(pattern, genome->view(), 4);
+}
+
+QueryResult HybridPicker::searchCached(const string& pattern,
+                                      const string& fastaPath,
+                                      const Query& q,
+                                      bool bothStrands) {
+    TRACE_SCOPE("picker.search_cached");
+    const string key = ResultCache::canonical(pattern);
+    const bool is_canonical = (key == pattern);
+    auto ref = ResultCache::identify(fastaPath);
+
+    optional<ResultCache::StrandResults> strands;
+    if (ref) strands = results.find(*ref, key, q);
+    if (!strands) {
+        auto genome = Genome::load(fastaPath);
+        auto matcher = createMatcher(recommendAlgorithm(key));
+        const string flipped = BioUtils::reverseComplement(key);
+
+        ResultCache::StrandResults computed;
+        computed.canonical = matcher->queryParallel(key, genome->view(), q, Genome::DEFAULT_THREADS);
+        computed.flipped = (flipped == key)
+            ? computed.canonical
+            : matcher->queryParallel(flipped, genome->view(), q, Genome::DEFAULT_THREADS);
+        if (ref) results.insert(*ref, key, q, computed);
+        strands = std::move(computed);
+    }
+
+    const QueryResult& forward = is_canonical ? strands->canonical : strands->flipped;
+    // A palindrome's reverse strand hits the same positions
+    if (!bothStrands || BioUtils::reverseComplement(key) == key) return forward;
+    const QueryResult& reverse = is_canonical ? strands->flipped : strands->canonical;
+
+    QueryResult both;
+    both.count = forward.count + reverse.count;
+    if (q.mode == QueryMode::Count) return both;
+    // Both lists are ascending; keep the mode's lowest hits of the union
+    both.positions.resize(forward.positions.size() + reverse.positions.size());
+    merge(forward.positions.begin(), forward.positions.end(),
+          reverse.positions.begin(), reverse.positions.end(), both.positions.begin());
+    const size_t wanted = (q.mode == QueryMode::Limit) ? q.limit : 1;
+    if (both.positions.size() > wanted) both.positions.resize(wanted);
+    both.count = both.positions.size();
+    return both;
+}
+
+// Stratified chunk sample over [0, n); countChunk(begin, end) counts the matches starting in a chunk
+template <typename CountChunk>
+static CountEstimate sampleEstimate(size_t n, size_t m, const EstimateOptions& opts, CountChunk countChunk) {
+    const auto started = chrono::steady_clock::now();
+    CountEstimate est;
+    if (m == 0 || n < m) {
+        est.exact = true;
+        return est;
+    }
+
+    const size_t chunk = max<size_t>(1, opts.chunk_size);
+    const size_t chunks = (n + chunk - 1) / chunk;
+    est.chunks_total = chunks;
+
+    // The first rounds give every stratum a few chunks, so its variance estimate is usable
+    size_t minimum = static_cast<size_t>(ceil(clamp(opts.sample_fraction, 0.0, 1.0) * chunks));
+    const size_t strata = clamp<size_t>(minimum / SAMPLES_PER_STRATUM, 1, max<size_t>(1, chunks / 2));
+
+    // Stratum h holds chunks [bounds[h], bounds[h + 1]), visited in a random order
+    vector<size_t> bounds(strata + 1);
+    for (size_t h = 0; h <= strata; ++h) bounds[h] = h * chunks / strata;
+    mt19937_64 rng(opts.seed ? opts.seed : random_device{}());
+    vector<vector<size_t>> order(strata);
+    for (size_t h = 0; h < strata; ++h) {
+        order[h].resize(bounds[h + 1] - bounds[h]);
+        iota(order[h].begin(), order[h].end(), bounds[h]);
+        shuffle(order[h].begin(), order[h].end(), rng);
+    }
+
+    vector<vector<double>> counts(strata);
+    auto finished = [&]() {
+        for (size_t h = 0; h < strata; ++h)
+            if (counts[h].size() < order[h].size()) return false;
+        return true;
+    };
+
+    // No hit in k chunks: a Poisson rate above -ln(alpha) / k per chunk would have shown
+    // one with probability 1 - alpha, alpha being the tail opts.z leaves (rule of three at 95%)
+    const double zero_hit_rate = -log(max(erfc(opts.z / sqrt(2.0)), 1e-300));
+
+    // Stratified estimator: sum of N_h * mean_h, variance with finite-population correction
+    auto evaluate = [&]() {
+        double total = 0, variance = 0, hits = 0;
+        size_t sampled = 0;
+        for (size_t h = 0; h < strata; ++h) {
+            const double N = static_cast<double>(order[h].size());
+            const double k = static_cast<double>(counts[h].size());
+            if (k == 0) continue;
+            const double mean = accumulate(counts[h].begin(), counts[h].end(), 0.0) / k;
+            double ss = 0;
+            for (double c : counts[h]) ss += (c - mean) * (c - mean);
+            const double s2 = k > 1 ? ss / (k - 1) : 0.0;
+            total += N * mean;
+            variance += N * N * (1.0 - k / N) * s2 / k;
+            hits += mean * k;
+            sampled += counts[h].size();
+        }
+        est.count = total;
+        est.chunks_sampled = sampled;
+        est.exact = finished();
+        double half = opts.z * sqrt(variance);
+        est.low = max(0.0, total - half);
+        est.high = total + half;
+        if (!est.exact && hits == 0) est.high = zero_hit_rate * static_cast<double>(chunks) / static_cast<double>(sampled);
+        est.relative_error = est.exact ? 0.0 : (total > 0 ? half / total : INFINITY);
+    };
+
+    for (size_t round = 0;; ++round) {
+        // One more chunk from every stratum that still has unsampled chunks
+        vector<size_t> batch;
+        vector<size_t> batch_stratum;
+        for (size_t h = 0; h < strata; ++h) {
+            if (counts[h].size() < order[h].size()) {
+                batch.push_back(order[h][counts[h].size()]);
+                batch_stratum.push_back(h);
+            }
+        }
+        if (batch.empty()) break;
+
+        vector<size_t> found(batch.size());
+        const long long count = static_cast<long long>(batch.size());
+        #pragma omp parallel for num_threads(max(1, opts.num_threads)) schedule(dynamic, 1)
+        for (long long i = 0; i < count; ++i) {
+            const size_t begin = batch[i] * chunk;
+            found[i] = countChunk(begin, min(n, begin + chunk));
+        }
+        for (size_t i = 0; i < batch.size(); ++i)
+            counts[batch_stratum[i]].push_back(static_cast<double>(found[i]));
+
+        evaluate();
+        if (est.exact) break;
+        if (round + 1 < SAMPLES_PER_STRATUM || est.chunks_sampled < minimum) continue;
+
+        const bool has_target = opts.target_relative_error > 0;
+        const bool has_budget = opts.time_budget_ms > 0;
+        if (!has_target && !has_budget) break;
+        if (has_target && est.relative_error <= opts.target_relative_error) break;
+        const double elapsed = chrono::duration<double, milli>(chrono::steady_clock::now() - started).count();
+        if (has_budget && elapsed >= opts.time_budget_ms) break;
+    }
+    return est;
+}
+
+CountEstimate HybridPicker::estimateCount(const string& pattern, string_view text, const EstimateOptions& opts) {
+    TRACE_SCOPE("picker.estimate");
+    auto matcher = createMatcher(recommendAlgorithm(pattern));
+    auto compiled = PatternMatcher::compile(pattern);
+    return sampleEstimate(text.size(), pattern.size(), opts, [&](size_t begin, size_t end) {
+        return matcher->searchRange(compiled->forward(), text, begin, end);
+    });
+}
+
+CountEstimate HybridPicker::estimateCountInFasta(const string& pattern, const string& fastaPath,
+                                                 const EstimateOptions& opts) {
+    TRACE_SCOPE("picker.estimate_fasta");
+    optional<GenomeCache> cache = GenomeCache::open(fastaPath);
+    if (!cache) {
+        // One parse writes the cache; a read-only directory leaves only the parsed text to sample
+        vector<GenomeCache::Record> records;
+        const string seq = FastaReader::parseSequence(fastaPath, &records);
+        if (!GenomeCache::write(fastaPath, seq, records) || !(cache = GenomeCache::open(fastaPath)))
+            return estimateCount(pattern, seq, opts);
+    }
+
+    // Only the sampled chunks are decoded, each with the m - 1 bases its last windows reach into
+    const GenomeCache& packed = *cache;
+    const size_t n = packed.size(), m = pattern.size();
+    auto matcher = createMatcher(recommendAlgorithm(pattern));
+    auto compiled = PatternMatcher::compile(pattern);
+    return sampleEstimate(n, m, opts, [&](size_t begin, size_t end) {
+        string window(min(n, end + m - 1) - begin, 'N');
+        packed.decode(window.data(), begin, begin + window.size());
+        return matcher->searchRange(compiled->forward(), window, 0, end - begin);
+    });
+}
 
 string HybridPicker::recommendAlgorithm(const string& pattern) {
+    TRACE_SCOPE("picker.recommend");
     size_t length = pattern.length();
     double entropy = BioUtils::calculateShannonEntropy(pattern);
-    double gc_content = BioUtils::calculateGCContent(pattern);
-    double repetitiveness = 2.0 - entropy;
     
-    // Decision Tree
-    if (length <= 64) {
+    // Decision Tree (model/best_algo_decision_tree.pkl: reference-host timings, bndm scaled in)
+    if (length < MIN_FACTOR_LENGTH) {
         return "bithiftor";
     }
-    if (repetitiveness >= 1.5) {
-        return "kmp";
-    }
-    if (length > 1000 && entropy >= 1.2) {
-        return "bmh";
-    }
-    if (gc_content >= 0.65 && length <= 500) {
-        return "bmh";
+    string algorithm = (length >= LONG_PATTERN && entropy < LOW_ENTROPY_PATTERN) ? "bmh" : "bndm";
+    return qgramMeasuredFaster(algorithm) ? "qbmh" : algorithm;
+}
+
+string HybridPicker::recommendAlgorithm(const string& pattern, const RegionComposition& region) {
+    string algorithm = recommendAlgorithm(pattern);
+    // Shift-or does the same work per base whatever the text looks like
+    if (algorithm == "bithiftor") {
+        return algorithm;
     }
-    if (length > 2000) {
-        return "kmp";
+    // Skip-based engines collapse on low-complexity text; KMP never re-reads a base
+    if (region.entropy < LOW_COMPLEXITY_ENTROPY ||
+        region.homopolymer_density >= LOW_COMPLEXITY_HOMOPOLYMER ||
+        region.repeat_density >= LOW_COMPLEXITY_REPEAT) {
+        return pattern.length() <= 64 ? "bithiftor" : "kmp";
     }
-    if (repetitiveness >= 1.0) {
-        return "kmp";
+    // Skips shrink when the region's common bases sit late in the pattern
+    if (expectedHorspoolShift(pattern, region.counts) < MIN_HORSPOOL_SHIFT) {
+        return pattern.length() <= 64 ? "bithiftor" : "kmp";
     }
-    return "bmh";
+    return algorithm;
+}
+
+vector<string> HybridPicker::recommendAlgorithmsByRegion(const string& pattern,
+                                                         const CompositionProfile& profile) {
+    vector<string> picks;
+    picks.reserve(profile.windows().size());
+    for (const RegionComposition& region : profile.windows())
+        picks.push_back(recommendAlgorithm(pattern, region));
+    return picks;
 }
 
 vector<string> HybridPicker::getAvailableAlgorithms() const {
-    return {"bmh", "kmp", "bithiftor"};
+    return {"bmh", "kmp", "bithiftor", "bndm", "qbmh"};
 }
 
 size_t HybridPicker::searchWithReverseComplementHybrid( const string& pattern, 
                                          const string& text, 
                                          const string& algorithmName, 
                                          bool parallel) {
+    TRACE_SCOPE("picker.search_rc");
     auto matcher = createMatcher(algorithmName);
     if (!matcher) {
         throw invalid_argument("Unknown algorithm: " + algorithmName + 
-                              ". Available: bmh, kmp, bithiftor");
+                              ". Available: bmh, kmp, bithiftor, bndm, qbmh");
     }
     return matcher->searchWithReverseComplement(pattern, text, parallel);
 }
\ No newline at end of file
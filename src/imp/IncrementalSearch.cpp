@@ -0,0 +1,152 @@
+#include "../../include/IncrementalSearch.hpp"
+#include "../../include/KMP.hpp"
+#include "../../include/Trace.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <omp.h>
+#include <stdexcept>
+
+using namespace std;
+
+namespace {
+
+    // Collects one chunk's hits relative to its start
+    class ChunkSink : public MatchSink {
+    public:
+        ChunkSink(size_t base, vector<uint32_t>& hits) : base(base), hits(hits) {}
+
+        bool onMatch(size_t pos) override {
+            hits.push_back(static_cast<uint32_t>(pos - base));
+            return true;
+        }
+
+    private:
+        size_t base;
+        vector<uint32_t>& hits;
+    };
+}
+
+IncrementalSearch::IncrementalSearch(string pattern, string_view text, unique_ptr<PatternMatcher> matcher,
+                                     int num_threads, size_t chunk_size)
+    : pat(std::move(pattern)),
+      seq(text),
+      matcher(matcher ? std::move(matcher) : make_unique<KMP>()),
+      compiled(PatternMatcher::compile(pat)),
+      num_threads(num_threads <= 0 ? 1 : num_threads),
+      chunk_size(std::min<size_t>(chunk_size == 0 ? DEFAULT_CHUNK : chunk_size,
+                                  numeric_limits<uint32_t>::max())) {
+    TRACE_SCOPE("incremental.initial_scan");
+    splitInto(chunks, seq.size());
+    rebuildStarts();
+    rescan(0, chunks.size());
+}
+
+void IncrementalSearch::splitInto(vector<Chunk>& out, size_t length) const {
+    if (length == 0) return;
+    // Even pieces, so a chunk that grew past the bound splits into halves rather than full + sliver
+    const size_t pieces = (length + chunk_size - 1) / chunk_size;
+    for (size_t p = 0; p < pieces; ++p) {
+        Chunk c;
+        c.length = length / pieces + (p < length % pieces ? 1 : 0);
+        out.push_back(std::move(c));
+    }
+}
+
+void IncrementalSearch::rebuildStarts() {
+    starts.resize(chunks.size() + 1);
+    starts[0] = 0;
+    for (size_t c = 0; c < chunks.size(); ++c) starts[c + 1] = starts[c] + chunks[c].length;
+}
+
+size_t IncrementalSearch::chunkOf(size_t pos) const {
+    if (chunks.empty()) return 0;
+    size_t c = static_cast<size_t>(upper_bound(starts.begin(), starts.end(), pos) - starts.begin());
+    return std::min(c == 0 ? 0 : c - 1, chunks.size() - 1);
+}
+
+void IncrementalSearch::rescan(size_t first, size_t last) {
+    TRACE_SCOPE("incremental.rescan");
+    rescanned = 0;
+    const size_t m = pat.size();
+    if (m != 0 && seq.size() >= m) {
+        const string_view text = seq;
+        const long long count = static_cast<long long>(last - first);
+        size_t bases = 0;
+
+        // Each chunk owns the matches starting inside it; kernels read m - 1 bases past its end
+        #pragma omp parallel for num_threads(num_threads) schedule(dynamic, 1) reduction(+: bases) if (count > 1)
+        for (long long i = 0; i < count; ++i) {
+            Chunk& chunk = chunks[first + i];
+            const size_t begin = starts[first + i];
+            chunk.hits.clear();
+            ChunkSink sink(begin, chunk.hits);
+            matcher->scanRange(compiled->forward(), text, begin, begin + chunk.length, sink);
+            bases += chunk.length;
+        }
+        rescanned = bases;
+    } else {
+        for (size_t c = first; c < last; ++c) chunks[c].hits.clear();
+    }
+
+    total = 0;
+    for (const Chunk& c : chunks) total += c.hits.size();
+}
+
+void IncrementalSearch::append(string_view bases) {
+    replace(seq.size(), 0, bases);
+}
+
+void IncrementalSearch::replace(size_t pos, size_t len, string_view bases) {
+    TRACE_SCOPE("incremental.replace");
+    if (pos > seq.size()) throw out_of_range("IncrementalSearch::replace: position past the end");
+    len = std::min(len, seq.size() - pos);
+    const size_t m = pat.size();
+
+    // Chunks [a, b] hold the replaced bases; a zero-length edit belongs to the chunk holding pos
+    // (the last chunk for an append)
+    const size_t a = chunkOf(pos);
+    const size_t b = len == 0 ? a : chunkOf(pos + len - 1);
+    size_t merged = 0;
+    if (!chunks.empty())
+        merged = starts[b + 1] - starts[a] - len;
+    merged += bases.size();
+
+    vector<Chunk> pieces;
+    splitInto(pieces, merged);
+    const size_t piece_count = pieces.size();
+    if (chunks.empty()) {
+        chunks = std::move(pieces);
+    } else {
+        chunks.erase(chunks.begin() + a, chunks.begin() + b + 1);
+        chunks.insert(chunks.begin() + a, make_move_iterator(pieces.begin()), make_move_iterator(pieces.end()));
+    }
+    seq.replace(pos, len, bases);
+    rebuildStarts();
+
+    // Matches starting up to m - 1 bases before the edit can read it, so their chunks rescan too
+    const size_t first = chunkOf(pos >= m ? pos - (m - 1) : 0);
+    const size_t last = std::max(a + piece_count, std::min(first + 1, chunks.size()));
+    rescan(std::min(first, a), std::min(last, chunks.size()));
+}
+
+vector<size_t> IncrementalSearch::positions() const {
+    vector<size_t> out;
+    out.reserve(total);
+    for (size_t c = 0; c < chunks.size(); ++c)
+        for (uint32_t h : chunks[c].hits) out.push_back(starts[c] + h);
+    return out;
+}
+
+QueryResult IncrementalSearch::result(const Query& q) const {
+    if (q.mode == QueryMode::Count) return {total, {}};
+    const size_t wanted = q.mode == QueryMode::Limit ? q.limit : 1;
+    QueryResult r;
+    for (size_t c = 0; c < chunks.size() && r.positions.size() < wanted; ++c)
+        for (uint32_t h : chunks[c].hits) {
+            if (r.positions.size() == wanted) break;
+            r.positions.push_back(starts[c] + h);
+        }
+    r.count = r.positions.size();
+    return r;
+}
@@ -1,8 +1,15 @@
 #include "../../include/KMP.hpp"
 #include "../../include/FastaReader.hpp"
 #include "../../include/BioUtils.hpp"
+#include "../../include/Arena.hpp"
+#include "../../include/Genome.hpp"
+#include "../../include/Calibration.hpp"
+#include "../../include/Numa.hpp"
+#include "../../include/Trace.hpp"
 
+#include <memory_resource>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <algorithm>
 #include <cstdint>
@@ -14,37 +21,104 @@
 #include <cctype>
 using namespace std;
 
-// Minimum characters per thread to justify parallelism (tuneable)
-static constexpr size_t MIN_PER_THREAD = 1 << 16; // 64k
+namespace {
 
-std::vector<size_t> KMP::computeLPS(const std::string& pattern) const {
+    // Counting receiver for the kernel below
+    struct Counter {
+        size_t count = 0;
+        bool onMatch(size_t) { ++count; return true; }
+        bool keepScanning() { return true; }
+    };
+
+    // Starting from an empty state at begin finds every match starting at or after begin
+    template <typename Sink>
+    void kmpRange(const uint32_t* lps, std::string_view pattern, std::string_view text,
+                  size_t begin, size_t end, Sink& sink) {
+        const size_t n = text.size(), m = pattern.size();
+        size_t j = 0;
+        size_t next_poll = begin;
+        const size_t scan_end = std::min(n, end + (m - 1));
+        for (size_t i = begin; i < scan_end; ++i) {
+            if (i >= next_poll) {
+                if (!sink.keepScanning()) return;
+                next_poll = i + MatchSink::POLL_INTERVAL;
+            }
+            while (j > 0 && pattern[j] != text[i]) j = lps[j - 1];
+            if (pattern[j] == text[i]) ++j;
+            if (j == m) {
+                if (!sink.onMatch(i + 1 - m)) return;
+                j = lps[j - 1];
+            }
+        }
+    }
+
+    size_t countRange(const uint32_t* lps, std::string_view pattern, std::string_view text,
+                      size_t begin, size_t end) {
+        Counter counter;
+        kmpRange(lps, pattern, text, begin, end, counter);
+        return counter.count;
+    }
+}
+
+void KMP::buildLPS(std::string_view pattern, uint32_t* lps) {
+    TRACE_SCOPE("kmp.lps");
     size_t m = pattern.size();
-    std::vector<size_t> lps(m, 0);
+    if (m == 0) return;
+    lps[0] = 0;
     size_t len = 0;
     for (size_t i = 1; i < m; ++i) {
         while (len > 0 && pattern[i] != pattern[len]) len = lps[len - 1];
         if (pattern[i] == pattern[len]) ++len;
-        lps[i] = len;
+        lps[i] = static_cast<uint32_t>(len);
     }
-    return lps;
 }
 
-size_t KMP::search(const string& pattern, const string& text) const {
+size_t KMP::search(std::string_view pattern, std::string_view text) const {
+    return searchRange(pattern, text, 0, text.size());
+}
+
+size_t KMP::searchRange(std::string_view pattern, std::string_view text, size_t begin, size_t end) const {
+    TRACE_SCOPE("kmp.scan_range");
     const size_t n = text.size(), m = pattern.size();
-    if (m == 0 || n < m) return 0;
+    end = std::min(end, n);
+    if (m == 0 || n < m || begin >= end) return 0;
 
-    std::vector<size_t> lps = computeLPS(pattern);
-    size_t j = 0;
-    size_t count = 0;
-    for (size_t i = 0; i < n; ++i) {
-        while (j > 0 && pattern[j] != text[i]) j = lps[j - 1];
-        if (pattern[j] == text[i]) ++j;
-        if (j == m) {
-            ++count;
-            j = lps[j - 1];
-        }
-    }
-    return count;
+    Arena::Scope scratch;
+    std::pmr::vector<uint32_t> lps(m, scratch.resource());
+    buildLPS(pattern, lps.data());
+    return countRange(lps.data(), pattern, text, begin, end);
+}
+
+void KMP::scanRange(std::string_view pattern, std::string_view text, size_t begin, size_t end, MatchSink& sink) const {
+    TRACE_SCOPE("kmp.scan_query");
+    const size_t n = text.size(), m = pattern.size();
+    end = std::min(end, n);
+    if (m == 0 || n < m || begin >= end) return;
+
+    Arena::Scope scratch;
+    std::pmr::vector<uint32_t> lps(m, scratch.resource());
+    buildLPS(pattern, lps.data());
+    kmpRange(lps.data(), pattern, text, begin, end, sink);
+}
+
+size_t KMP::searchRange(const CompiledStrand& pattern, std::string_view text, size_t begin, size_t end) const {
+    TRACE_SCOPE("kmp.scan_range");
+    const size_t n = text.size(), m = pattern.size();
+    end = std::min(end, n);
+    if (m == 0 || n < m || begin >= end) return 0;
+    return countRange(pattern.lps.data(), pattern.bases, text, begin, end);
+}
+
+void KMP::scanRange(const CompiledStrand& pattern, std::string_view text, size_t begin, size_t end, MatchSink& sink) const {
+    TRACE_SCOPE("kmp.scan_query");
+    const size_t n = text.size(), m = pattern.size();
+    end = std::min(end, n);
+    if (m == 0 || n < m || begin >= end) return;
+    kmpRange(pattern.lps.data(), pattern.bases, text, begin, end, sink);
+}
+
+string_view KMP::name() const {
+    return "kmp";
 }
 
 size_t KMP::searchInFasta(const string& pattern, const string& fastaPath) const {
@@ -52,22 +126,25 @@ size_t KMP::searchInFasta(const string& pattern, const string& fastaPath) const
     return search(pattern, dnaSequence);
 }
 
-size_t KMP::searchParallel(const std::string& pattern, const std::string& text, int num_threads) const {
+size_t KMP::searchParallel(std::string_view pattern, std::string_view text, int num_threads) const {
+    TRACE_SCOPE("kmp.search_parallel");
      const size_t n = text.size(), m = pattern.size();
     if (m == 0 || n < m) return 0;
-    if (num_threads <= 0) num_threads = 1;
-    if (n < static_cast<size_t>(num_threads) * MIN_PER_THREAD) num_threads = 1;
+    num_threads = Calibration::threadsFor(name(), n, num_threads);
 
-    std::vector<size_t> lps = computeLPS(pattern);
+    Arena::Scope scratch;
+    std::pmr::vector<uint32_t> lps(m, scratch.resource());
+    buildLPS(pattern, lps.data());
     size_t total_count = 0;
 
     #pragma omp parallel num_threads(num_threads) reduction(+: total_count)
     {
         int tid = omp_get_thread_num();
         size_t chunk = (n + num_threads - 1) / num_threads;
-        size_t worker_start = tid * chunk;
-        size_t worker_end = std::min(n, (tid + 1) * chunk);
-        if (worker_start >= worker_end) {}
+        size_t worker_start = std::min(n, tid * chunk);
+        size_t worker_end = std::min(n, worker_start + chunk);
+        Numa::bindWorker(tid, num_threads);
+        TRACE_SCOPE("kmp.scan_chunk");
 
         size_t j = 0;
         size_t prefix_from = (worker_start >= (m - 1)) ? (worker_start - (m - 1)) : 0;
@@ -93,12 +170,14 @@ size_t KMP::searchParallel(const std::string& pattern, const std::string& text,
 
 size_t KMP::searchParallelInFasta(const std::string& pattern, const std::string& fastaPath) const {
     int num_threads = 4; // Default to 4 threads
-    string dnaSequence = FastaReader::readSequence(fastaPath);
-    return searchParallel(pattern, dnaSequence, num_threads);
+    auto genome = Genome::load(fastaPath, num_threads);
+    return searchParallel(pattern, genome->view(), num_threads);
 }
 
-size_t KMP::searchWithReverseComplement(const std::string& pattern, const std::string& text, bool parallel) const {
-    std::string rc_pattern = BioUtils::reverseComplement(pattern);
+size_t KMP::searchWithReverseComplement(std::string_view pattern, std::string_view text, bool parallel) const {
+    TRACE_SCOPE("kmp.search_rc");
+    Arena::Scope scratch;
+    std::pmr::string rc_pattern = BioUtils::reverseComplement(pattern, scratch.resource());
     
     if (parallel) {
         int num_threads = 4;
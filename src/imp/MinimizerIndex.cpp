@@ -0,0 +1,461 @@
+#include "../../include/MinimizerIndex.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <stdexcept>
+#include <utility>
+#include <fcntl.h>
+#include <omp.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace std;
+
+namespace {
+
+    constexpr char MAGIC[8] = {'D', 'N', 'A', 'M', 'I', 'D', 'X', '\0'};
+    constexpr uint32_t FORMAT_VERSION = 3;
+    constexpr size_t HEADER_BYTES = 64;
+    constexpr unsigned MAX_K = 31;
+    constexpr unsigned MAX_W = 255;
+    constexpr size_t HASH_BLOCK = 1 << 20;  // fixed, so the hash does not depend on the thread count
+
+    struct FileHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t k;
+        uint32_t w;
+        uint32_t reserved;
+        uint64_t text_length;
+        uint64_t text_hash;
+        uint64_t table_size;
+        uint64_t positions_size;
+        uint64_t index_hash;  // table and positions, so a damaged file is refused on load
+    };
+    static_assert(sizeof(FileHeader) <= HEADER_BYTES, "header must fit its reserved block");
+
+    struct Seed {
+        uint64_t key;
+        uint32_t pos;
+        bool operator<(const Seed& o) const { return key != o.key ? key < o.key : pos < o.pos; }
+        bool operator==(const Seed& o) const { return key == o.key && pos == o.pos; }
+    };
+
+    // 2-bit code, soft-masked bases included; anything else breaks the k-mer
+    inline int baseCode(char c) {
+        switch (c) {
+            case 'A': case 'a': return 0;
+            case 'C': case 'c': return 1;
+            case 'G': case 'g': return 2;
+            case 'T': case 't': return 3;
+            default: return -1;
+        }
+    }
+
+    // Invertible mix on the low 2k bits: the minimizer order, so poly-A is not always the minimum
+    inline uint64_t orderHash(uint64_t key, uint64_t mask) {
+        key = (~key + (key << 21)) & mask;
+        key = key ^ (key >> 24);
+        key = ((key + (key << 3)) + (key << 8)) & mask;
+        key = key ^ (key >> 14);
+        key = ((key + (key << 2)) + (key << 4)) & mask;
+        key = key ^ (key >> 28);
+        key = (key + (key << 31)) & mask;
+        return key;
+    }
+
+    // Table slot hash, independent of the order hash
+    inline uint64_t slotHash(uint64_t key) {
+        key ^= key >> 33;
+        key *= 0xff51afd7ed558ccdULL;
+        key ^= key >> 33;
+        key *= 0xc4ceb9fe1a85ec53ULL;
+        key ^= key >> 33;
+        return key;
+    }
+
+    inline uint64_t mixWord(uint64_t h, uint64_t w) {
+        h = (h ^ w) * 0x9e3779b97f4a7c15ULL;
+        return h ^ (h >> 29);
+    }
+
+    // Every byte, so a same-length edit (a SNP fix, a swapped contig) changes it
+    uint64_t hashBytes(string_view text) {
+        const size_t n = text.size();
+        const size_t blocks = (n + HASH_BLOCK - 1) / HASH_BLOCK;
+        vector<uint64_t> block_hash(blocks);
+
+        #pragma omp parallel for schedule(static)
+        for (size_t b = 0; b < blocks; ++b) {
+            const size_t begin = b * HASH_BLOCK, end = min(n, begin + HASH_BLOCK);
+            uint64_t h = mixWord(0xcbf29ce484222325ULL, b);
+            size_t i = begin;
+            for (; i + 8 <= end; i += 8) {
+                uint64_t w;
+                memcpy(&w, text.data() + i, sizeof(w));
+                h = mixWord(h, w);
+            }
+            for (; i < end; ++i) h = mixWord(h, static_cast<unsigned char>(text[i]));
+            block_hash[b] = h;
+        }
+
+        uint64_t h = mixWord(0x84222325cbf29ce4ULL, n);
+        for (uint64_t bh : block_hash) h = mixWord(h, bh);
+        return h;
+    }
+
+    uint64_t hashIndex(const MinimizerIndex::Slot* table, size_t table_size, const uint32_t* positions,
+                       size_t positions_size) {
+        const string_view slots(reinterpret_cast<const char*>(table), table_size * sizeof(MinimizerIndex::Slot));
+        const string_view seeds(reinterpret_cast<const char*>(positions), positions_size * sizeof(uint32_t));
+        return mixWord(hashBytes(slots), hashBytes(seeds));
+    }
+
+    // Header fields agree with each other and with the file size, without overflowing
+    bool layoutValid(const FileHeader& h, size_t bytes) {
+        if (memcmp(h.magic, MAGIC, sizeof(MAGIC)) != 0 || h.version != FORMAT_VERSION) return false;
+        if (h.k == 0 || h.k > MAX_K || h.w == 0 || h.w > MAX_W) return false;
+        if (h.table_size == 0 || (h.table_size & (h.table_size - 1)) != 0) return false;
+        const size_t body = bytes - HEADER_BYTES;
+        if (h.table_size > body / sizeof(MinimizerIndex::Slot)) return false;
+        const size_t rest = body - h.table_size * sizeof(MinimizerIndex::Slot);
+        return rest % sizeof(uint32_t) == 0 && h.positions_size == rest / sizeof(uint32_t);
+    }
+
+    // Every slot points inside the positions array, and at least one is empty so lookup() ends
+    bool tableValid(const MinimizerIndex::Slot* table, size_t table_size, size_t positions_size) {
+        bool has_empty = false;
+        for (size_t i = 0; i < table_size; ++i) {
+            const MinimizerIndex::Slot& slot = table[i];
+            if (slot.key == MinimizerIndex::EMPTY_KEY) {
+                has_empty = true;
+                continue;
+            }
+            if (slot.count == 0 || uint64_t{slot.offset} + slot.count > positions_size) return false;
+        }
+        return has_empty;
+    }
+
+    /**
+     * Calls emit(key, pos) for the minimizer of every window whose first k-mer
+     * lies in [first_window, last_window), skipping repeats of the previous one.
+     * Windows holding no A/C/G/T k-mer have no minimizer.
+     */
+    template <typename Emit>
+    void forEachMinimizer(string_view text, unsigned k, unsigned w,
+                          size_t first_window, size_t last_window, Emit&& emit) {
+        if (text.size() < k || first_window >= last_window) return;
+        const uint64_t mask = (k == 32) ? ~0ULL : ((1ULL << (2 * k)) - 1);
+
+        // (order, position, key) of candidate k-mers; front is the window minimum
+        struct Entry { uint64_t order; size_t pos; uint64_t key; };
+        deque<Entry> window;
+
+        uint64_t code = 0;
+        unsigned valid = 0;
+        size_t last_emitted = SIZE_MAX;
+        const size_t end_kmer = last_window + w - 1;  // one past the last k-mer needed
+
+        for (size_t i = first_window; i < end_kmer + k - 1 && i < text.size(); ++i) {
+            int c = baseCode(text[i]);
+            if (c < 0) {
+                valid = 0;
+                code = 0;
+            } else {
+                code = ((code << 2) | static_cast<uint64_t>(c)) & mask;
+                if (valid < k) ++valid;
+            }
+            if (i + 1 < first_window + k) continue;
+
+            const size_t kmer_pos = i + 1 - k;
+            if (valid == k) {
+                const uint64_t order = orderHash(code, mask);
+                // Keep equal orders already queued: ties go to the leftmost k-mer
+                while (!window.empty() && window.back().order > order) window.pop_back();
+                window.push_back({order, kmer_pos, code});
+            }
+            if (kmer_pos + 1 < first_window + w) continue;
+
+            const size_t window_start = kmer_pos + 1 - w;
+            while (!window.empty() && window.front().pos < window_start) window.pop_front();
+            if (!window.empty() && window.front().pos != last_emitted) {
+                last_emitted = window.front().pos;
+                emit(window.front().key, last_emitted);
+            }
+        }
+    }
+
+} // namespace
+
+MinimizerIndex::~MinimizerIndex() {
+    reset();
+}
+
+MinimizerIndex::MinimizerIndex(MinimizerIndex&& other) noexcept {
+    *this = std::move(other);
+}
+
+MinimizerIndex& MinimizerIndex::operator=(MinimizerIndex&& other) noexcept {
+    if (this == &other) return *this;
+    reset();
+    k = other.k;
+    w = other.w;
+    text_length = other.text_length;
+    text_hash = other.text_hash;
+    table_size = other.table_size;
+    positions_size = other.positions_size;
+    table_storage = std::move(other.table_storage);
+    positions_storage = std::move(other.positions_storage);
+    mapping = std::exchange(other.mapping, nullptr);
+    mapping_size = std::exchange(other.mapping_size, 0);
+    // Moving a vector keeps its buffer, so the views stay valid
+    table = std::exchange(other.table, nullptr);
+    positions = std::exchange(other.positions, nullptr);
+    other.table_size = 0;
+    other.positions_size = 0;
+    return *this;
+}
+
+void MinimizerIndex::reset() {
+    if (mapping) munmap(mapping, mapping_size);
+    mapping = nullptr;
+    mapping_size = 0;
+    table_storage.clear();
+    positions_storage.clear();
+    table = nullptr;
+    positions = nullptr;
+    table_size = 0;
+    positions_size = 0;
+}
+
+MinimizerIndex MinimizerIndex::build(string_view text, unsigned k, unsigned w, int num_threads) {
+    if (k == 0 || k > MAX_K) throw invalid_argument("MinimizerIndex: k must be in [1, 31]");
+    if (w == 0 || w > MAX_W) throw invalid_argument("MinimizerIndex: w must be in [1, 255]");
+    if (text.size() > MAX_TEXT) throw length_error("MinimizerIndex: text longer than 4G bases");
+    if (num_threads < 1) num_threads = 1;
+
+    MinimizerIndex index;
+    index.k = k;
+    index.w = w;
+    index.text_length = text.size();
+    index.text_hash = hashBytes(text);
+
+    const size_t n = text.size();
+    const size_t windows = (n >= k + w - 1) ? n - (k + w - 1) + 1 : 0;
+    const size_t parts = static_cast<size_t>(num_threads);
+
+    // buckets[t][p]: seeds found by thread t whose key hashes to partition p
+    vector<vector<vector<Seed>>> buckets(parts, vector<vector<Seed>>(parts));
+
+    #pragma omp parallel num_threads(num_threads)
+    {
+        const size_t tid = static_cast<size_t>(omp_get_thread_num());
+        const size_t workers = static_cast<size_t>(omp_get_num_threads());
+        const size_t chunk = (windows + workers - 1) / max<size_t>(workers, 1);
+        const size_t worker_start = min(windows, tid * chunk);
+        const size_t worker_end = min(windows, worker_start + chunk);
+
+        auto& mine = buckets[tid];
+        forEachMinimizer(text, k, w, worker_start, worker_end, [&](uint64_t key, size_t pos) {
+            mine[slotHash(key) % parts].push_back({key, static_cast<uint32_t>(pos)});
+        });
+    }
+
+    // Each partition is sorted by its own thread; a window run split across two
+    // threads can report the same seed twice, which unique() drops
+    vector<vector<Seed>> partitions(parts);
+    vector<size_t> distinct(parts, 0);
+    #pragma omp parallel for num_threads(num_threads) schedule(dynamic, 1)
+    for (size_t p = 0; p < parts; ++p) {
+        size_t total = 0;
+        for (size_t t = 0; t < parts; ++t) total += buckets[t][p].size();
+        auto& seeds = partitions[p];
+        seeds.reserve(total);
+        for (size_t t = 0; t < parts; ++t) {
+            seeds.insert(seeds.end(), buckets[t][p].begin(), buckets[t][p].end());
+            vector<Seed>().swap(buckets[t][p]);
+        }
+        sort(seeds.begin(), seeds.end());
+        seeds.erase(unique(seeds.begin(), seeds.end()), seeds.end());
+        for (size_t i = 0; i < seeds.size(); ++i)
+            if (i == 0 || seeds[i].key != seeds[i - 1].key) ++distinct[p];
+    }
+
+    vector<size_t> base(parts + 1, 0);
+    size_t keys = 0;
+    for (size_t p = 0; p < parts; ++p) {
+        base[p + 1] = base[p] + partitions[p].size();
+        keys += distinct[p];
+    }
+
+    // Load factor at most 1/2
+    size_t capacity = 16;
+    while (capacity < 2 * keys) capacity <<= 1;
+    index.table_storage.assign(capacity, Slot{EMPTY_KEY, 0, 0});
+    index.positions_storage.resize(base[parts]);
+    Slot* slots = index.table_storage.data();
+    uint32_t* csr = index.positions_storage.data();
+
+    #pragma omp parallel for num_threads(num_threads) schedule(dynamic, 1)
+    for (size_t p = 0; p < parts; ++p) {
+        const auto& seeds = partitions[p];
+        size_t i = 0;
+        while (i < seeds.size()) {
+            size_t j = i;
+            while (j < seeds.size() && seeds[j].key == seeds[i].key) {
+                csr[base[p] + j] = seeds[j].pos;
+                ++j;
+            }
+            // Keys are unique across partitions, so a lost race only means the slot is taken
+            size_t slot = slotHash(seeds[i].key) & (capacity - 1);
+            while (true) {
+                atomic_ref<uint64_t> key_ref(slots[slot].key);
+                uint64_t expected = EMPTY_KEY;
+                if (key_ref.compare_exchange_strong(expected, seeds[i].key, memory_order_relaxed)) break;
+                slot = (slot + 1) & (capacity - 1);
+            }
+            slots[slot].offset = static_cast<uint32_t>(base[p] + i);
+            slots[slot].count = static_cast<uint32_t>(j - i);
+            i = j;
+        }
+    }
+
+    index.table = index.table_storage.data();
+    index.table_size = capacity;
+    index.positions = index.positions_storage.data();
+    index.positions_size = index.positions_storage.size();
+    return index;
+}
+
+void MinimizerIndex::save(const string& path) const {
+    ofstream out(path, ios::binary | ios::trunc);
+    if (!out) throw runtime_error("MinimizerIndex: cannot write " + path);
+
+    FileHeader header{};
+    memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = FORMAT_VERSION;
+    header.k = k;
+    header.w = w;
+    header.text_length = text_length;
+    header.text_hash = text_hash;
+    header.table_size = table_size;
+    header.positions_size = positions_size;
+    header.index_hash = hashIndex(table, table_size, positions, positions_size);
+
+    char block[HEADER_BYTES] = {};
+    memcpy(block, &header, sizeof(header));
+    out.write(block, sizeof(block));
+    out.write(reinterpret_cast<const char*>(table), static_cast<streamsize>(table_size * sizeof(Slot)));
+    out.write(reinterpret_cast<const char*>(positions), static_cast<streamsize>(positions_size * sizeof(uint32_t)));
+    if (!out) throw runtime_error("MinimizerIndex: short write to " + path);
+}
+
+MinimizerIndex MinimizerIndex::load(const string& path) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) throw runtime_error("MinimizerIndex: cannot open " + path);
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < HEADER_BYTES) {
+        close(fd);
+        throw runtime_error("MinimizerIndex: truncated index " + path);
+    }
+    const size_t bytes = static_cast<size_t>(st.st_size);
+    void* mapped = mmap(nullptr, bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED) throw runtime_error("MinimizerIndex: cannot map " + path);
+
+    FileHeader header;
+    memcpy(&header, mapped, sizeof(header));
+    if (!layoutValid(header, bytes)) {
+        munmap(mapped, bytes);
+        throw runtime_error("MinimizerIndex: " + path + " is not a version " + to_string(FORMAT_VERSION) + " index");
+    }
+    const char* base = static_cast<const char*>(mapped);
+    const Slot* table = reinterpret_cast<const Slot*>(base + HEADER_BYTES);
+    const uint32_t* positions = reinterpret_cast<const uint32_t*>(base + HEADER_BYTES + header.table_size * sizeof(Slot));
+    // The hash catches damage; the table check also stops a file with a matching hash
+    // from sending lookup() into an endless probe or find() past the positions
+    if (hashIndex(table, header.table_size, positions, header.positions_size) != header.index_hash
+        || !tableValid(table, header.table_size, header.positions_size)) {
+        munmap(mapped, bytes);
+        throw runtime_error("MinimizerIndex: " + path + " is corrupt");
+    }
+    // Lookups touch a handful of slots each; read-ahead would only pollute the cache
+    madvise(mapped, bytes, MADV_RANDOM);
+
+    MinimizerIndex index;
+    index.k = header.k;
+    index.w = header.w;
+    index.text_length = header.text_length;
+    index.text_hash = header.text_hash;
+    index.mapping = mapped;
+    index.mapping_size = bytes;
+    index.table = table;
+    index.table_size = header.table_size;
+    index.positions = positions;
+    index.positions_size = header.positions_size;
+    return index;
+}
+
+bool MinimizerIndex::matches(string_view text) const {
+    return text.size() == text_length && hashBytes(text) == text_hash;
+}
+
+const MinimizerIndex::Slot* MinimizerIndex::lookup(uint64_t key) const {
+    if (table_size == 0) return nullptr;
+    size_t slot = slotHash(key) & (table_size - 1);
+    while (table[slot].key != EMPTY_KEY) {
+        if (table[slot].key == key) return &table[slot];
+        slot = (slot + 1) & (table_size - 1);
+    }
+    return nullptr;
+}
+
+bool MinimizerIndex::canAnswer(string_view pattern) const {
+    if (pattern.size() < minPatternLength()) return false;
+    bool found = false;
+    const size_t windows = pattern.size() - minPatternLength() + 1;
+    forEachMinimizer(pattern, k, w, 0, windows, [&](uint64_t, size_t) { found = true; });
+    return found;
+}
+
+vector<size_t> MinimizerIndex::find(string_view pattern, string_view text) const {
+    if (!canAnswer(pattern)) throw invalid_argument("MinimizerIndex: pattern has no full minimizer window");
+
+    // Every occurrence holds each of the pattern's minimizers at the same offset,
+    // so the rarest one alone bounds the candidates
+    const Slot* best = nullptr;
+    size_t best_offset = 0;
+    bool missing = false;
+    const size_t windows = pattern.size() - minPatternLength() + 1;
+    forEachMinimizer(pattern, k, w, 0, windows, [&](uint64_t key, size_t pos) {
+        if (missing) return;
+        const Slot* slot = lookup(key);
+        if (!slot) {
+            missing = true;
+            return;
+        }
+        if (!best || slot->count < best->count) {
+            best = slot;
+            best_offset = pos;
+        }
+    });
+
+    vector<size_t> hits;
+    if (missing) return hits;
+
+    const size_t m = pattern.size();
+    const size_t n = text.size();
+    const uint32_t* begin = positions + best->offset;
+    const uint32_t* end = begin + best->count;
+    for (const uint32_t* p = begin; p != end; ++p) {
+        if (*p < best_offset) continue;
+        const size_t start = *p - best_offset;
+        if (start + m > n) break;
+        if (memcmp(text.data() + start, pattern.data(), m) == 0) hits.push_back(start);
+    }
+    return hits;
+}
@@ -0,0 +1,199 @@
+#include "../../include/Numa.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <omp.h>
+#include <pthread.h>
+#include <sched.h>
+
+using namespace std;
+
+namespace {
+
+    struct Topology {
+        vector<int> cpus;            // usable CPUs, grouped by node
+        vector<int> node_of;         // node index per entry of cpus
+        vector<vector<int>> nodes;   // usable CPUs of each node
+    };
+
+    // sysfs list format: "0-3,8,10-11"
+    vector<int> parseCpuList(const string& list) {
+        vector<int> out;
+        size_t i = 0;
+        while (i < list.size()) {
+            if (!isdigit(static_cast<unsigned char>(list[i]))) { ++i; continue; }
+            size_t j = i;
+            int lo = stoi(list.substr(i), &j);
+            i += j;
+            int hi = lo;
+            if (i < list.size() && list[i] == '-') {
+                ++i;
+                hi = stoi(list.substr(i), &j);
+                i += j;
+            }
+            for (int c = lo; c <= hi; ++c) out.push_back(c);
+        }
+        return out;
+    }
+
+    Topology discover() {
+        cpu_set_t allowed;
+        CPU_ZERO(&allowed);
+        if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0)
+            for (int c = 0; c < CPU_SETSIZE; ++c) CPU_SET(c, &allowed);
+
+        Topology topo;
+        for (int node = 0; node < 1024; ++node) {
+            ifstream f("/sys/devices/system/node/node" + to_string(node) + "/cpulist");
+            if (!f) {
+                if (node > 0 || !topo.nodes.empty()) break;
+                continue;
+            }
+            string list;
+            getline(f, list);
+            vector<int> usable;
+            for (int c : parseCpuList(list))
+                if (c < CPU_SETSIZE && CPU_ISSET(c, &allowed)) usable.push_back(c);
+            if (!usable.empty()) topo.nodes.push_back(std::move(usable));
+        }
+        // No sysfs (containers, non-Linux layouts): one node with every allowed CPU
+        if (topo.nodes.empty()) {
+            vector<int> all;
+            for (int c = 0; c < CPU_SETSIZE; ++c)
+                if (CPU_ISSET(c, &allowed)) all.push_back(c);
+            if (all.empty()) all.push_back(0);
+            topo.nodes.push_back(std::move(all));
+        }
+        for (size_t node = 0; node < topo.nodes.size(); ++node) {
+            for (int c : topo.nodes[node]) {
+                topo.cpus.push_back(c);
+                topo.node_of.push_back(static_cast<int>(node));
+            }
+        }
+        return topo;
+    }
+
+    const Topology& topology() {
+        static const Topology topo = discover();
+        return topo;
+    }
+
+    Numa::Binding initialBinding() {
+        if (const char* env = getenv("DNASEQ_NUMA_BINDING")) {
+            string v(env);
+            if (v == "off") return Numa::Binding::Off;
+            if (v == "local") return Numa::Binding::Local;
+            if (v == "remote") return Numa::Binding::Remote;
+        }
+        return topology().nodes.size() > 1 ? Numa::Binding::Local : Numa::Binding::Off;
+    }
+
+    atomic<int>& bindingState() {
+        static atomic<int> state{static_cast<int>(initialBinding())};
+        return state;
+    }
+
+    thread_local int bound_cpu = -1;
+    // Affinity the thread had before its first pin, restored when pinning is turned off
+    thread_local cpu_set_t original_mask;
+    thread_local bool original_saved = false;
+    // Widest team that pinned workers, so restoreAffinity() reaches every pooled thread
+    atomic<int> widest_team{0};
+
+    void unpinCurrent() {
+        if (bound_cpu < 0 || !original_saved) return;
+        if (pthread_setaffinity_np(pthread_self(), sizeof(original_mask), &original_mask) == 0) bound_cpu = -1;
+    }
+
+    // Index into cpus() for chunk tid: even spread, so neighbouring chunks share a node
+    size_t slotFor(int tid, int num_threads) {
+        const size_t ncpu = topology().cpus.size();
+        if (num_threads <= 0) num_threads = 1;
+        return (static_cast<size_t>(tid) * ncpu / static_cast<size_t>(num_threads)) % ncpu;
+    }
+}
+
+namespace Numa {
+
+    Binding binding() {
+        return static_cast<Binding>(bindingState().load(memory_order_relaxed));
+    }
+
+    void setBinding(Binding b) {
+        bindingState().store(static_cast<int>(b), memory_order_relaxed);
+    }
+
+    string bindingName(Binding b) {
+        switch (b) {
+            case Binding::Off: return "off";
+            case Binding::Local: return "local";
+            case Binding::Remote: return "remote";
+        }
+        return "unknown";
+    }
+
+    int nodeCount() {
+        return static_cast<int>(topology().nodes.size());
+    }
+
+    const vector<int>& cpus() {
+        return topology().cpus;
+    }
+
+    int localCpu(int tid, int num_threads) {
+        return topology().cpus[slotFor(tid, num_threads)];
+    }
+
+    void bindWorker(int tid, int num_threads) {
+        bindWorker(tid, num_threads, binding());
+    }
+
+    void bindWorker(int tid, int num_threads, Binding b) {
+        if (b == Binding::Off) {
+            unpinCurrent();
+            return;
+        }
+        // Team member 0 is the caller's own thread: it outlives the region, and threads or
+        // processes it starts later would inherit a one-CPU mask, so it is never pinned
+        if (omp_get_thread_num() == 0) return;
+        const Topology& topo = topology();
+        const size_t slot = slotFor(tid, num_threads);
+        int cpu = topo.cpus[slot];
+        if (b == Binding::Remote && topo.nodes.size() > 1) {
+            // Same rank within the next node, so remote workers stay spread too
+            const int node = topo.node_of[slot];
+            const auto& home = topo.nodes[node];
+            const size_t rank = static_cast<size_t>(find(home.begin(), home.end(), cpu) - home.begin());
+            const auto& away = topo.nodes[(node + 1) % topo.nodes.size()];
+            cpu = away[rank % away.size()];
+        }
+        if (cpu == bound_cpu) return;
+
+        if (!original_saved) {
+            CPU_ZERO(&original_mask);
+            if (pthread_getaffinity_np(pthread_self(), sizeof(original_mask), &original_mask) != 0) return;
+            original_saved = true;
+        }
+        int widest = widest_team.load(memory_order_relaxed);
+        while (num_threads > widest && !widest_team.compare_exchange_weak(widest, num_threads, memory_order_relaxed)) {}
+
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0) bound_cpu = cpu;
+    }
+
+    void restoreAffinity() {
+        const int team = std::max(widest_team.load(memory_order_relaxed), omp_get_max_threads());
+        #pragma omp parallel num_threads(team)
+        {
+            unpinCurrent();
+        }
+        unpinCurrent();
+    }
+}
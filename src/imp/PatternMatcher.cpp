@@ -0,0 +1,185 @@
+#include "../../include/PatternMatcher.hpp"
+#include "../../include/Calibration.hpp"
+#include "../../include/Numa.hpp"
+#include "../../include/Trace.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <vector>
+#include <omp.h>
+
+using namespace std;
+
+namespace {
+
+    // Hits found so far by one worker, on its own cache line
+    struct alignas(64) HitCounter {
+        atomic<size_t> hits{0};
+    };
+
+    /**
+     * Worker t owns the t-th chunk. Its hits rank after every hit of workers
+     * 0..t-1, so it can stop once those already hold `wanted` hits between them;
+     * worker 0 never stops early, which keeps First / Limit globally lowest.
+     * Exists only needs some hit, so one shared flag stops everyone.
+     */
+    class QuerySink : public MatchSink {
+    public:
+        QuerySink(const Query& q, size_t wanted, int tid, vector<HitCounter>& counters,
+                  atomic<bool>& any, vector<size_t>& positions)
+            : mode(q.mode), wanted(wanted), tid(tid), counters(counters), any(any), positions(positions) {}
+
+        bool onMatch(size_t pos) override {
+            positions.push_back(pos);
+            counters[tid].hits.store(positions.size(), memory_order_relaxed);
+            if (mode == QueryMode::Exists) {
+                any.store(true, memory_order_relaxed);
+                return false;
+            }
+            return positions.size() < wanted;
+        }
+
+        bool keepScanning() override {
+            if (mode == QueryMode::Exists) return !any.load(memory_order_relaxed);
+            size_t before = 0;
+            for (int u = 0; u < tid; ++u) before += counters[u].hits.load(memory_order_relaxed);
+            return before < wanted;
+        }
+
+    private:
+        QueryMode mode;
+        size_t wanted;
+        int tid;
+        vector<HitCounter>& counters;
+        atomic<bool>& any;
+        vector<size_t>& positions;
+    };
+
+    size_t wantedHits(const Query& q) {
+        return q.mode == QueryMode::Limit ? q.limit : 1;
+    }
+
+    // Worker lists are chunk-ordered and ascending, so concatenation is sorted
+    QueryResult merge(const Query& q, vector<vector<size_t>>& local) {
+        QueryResult result;
+        for (auto& hits : local)
+            result.positions.insert(result.positions.end(), hits.begin(), hits.end());
+        if (result.positions.size() > wantedHits(q)) result.positions.resize(wantedHits(q));
+        result.count = result.positions.size();
+        return result;
+    }
+
+    // Serial query over [0, n); scan(begin, end, sink) runs the engine
+    template <typename Scan>
+    QueryResult runQuery(size_t n, size_t m, const Query& q, Scan scan) {
+        if (m == 0 || n < m || wantedHits(q) == 0) return {};
+
+        vector<HitCounter> counters(1);
+        atomic<bool> any{false};
+        vector<vector<size_t>> local(1);
+        QuerySink sink(q, wantedHits(q), 0, counters, any, local[0]);
+        scan(0, n, sink);
+        return merge(q, local);
+    }
+
+    // Static partition of one compiled strand, same layout as the engines' searchParallel
+    size_t countParallel(const PatternMatcher& matcher, const CompiledStrand& strand, string_view text, int num_threads) {
+        const size_t n = text.size(), m = strand.size();
+        if (m == 0 || n < m) return 0;
+        num_threads = Calibration::threadsFor(matcher.name(), n, num_threads);
+
+        size_t total_count = 0;
+        #pragma omp parallel num_threads(num_threads) reduction(+: total_count)
+        {
+            int tid = omp_get_thread_num();
+            size_t chunk = (n + num_threads - 1) / num_threads;
+            size_t worker_start = std::min(n, tid * chunk);
+            size_t worker_end = std::min(n, worker_start + chunk);
+            Numa::bindWorker(tid, num_threads);
+            TRACE_SCOPE("compiled.scan_chunk");
+
+            // Windows starting in [worker_start, worker_end) belong to this worker
+            total_count += matcher.searchRange(strand, text, worker_start, worker_end);
+        }
+        return total_count;
+    }
+
+    template <typename Scan>
+    QueryResult runQueryParallel(string_view engine, size_t n, size_t m, const Query& q, int num_threads, Scan scan) {
+        if (m == 0 || n < m || wantedHits(q) == 0) return {};
+        num_threads = Calibration::threadsFor(engine, n, num_threads);
+
+        vector<HitCounter> counters(num_threads);
+        atomic<bool> any{false};
+        vector<vector<size_t>> local(num_threads);
+
+        #pragma omp parallel num_threads(num_threads)
+        {
+            int tid = omp_get_thread_num();
+            size_t chunk = (n + num_threads - 1) / num_threads;
+            size_t worker_start = std::min(n, tid * chunk);
+            size_t worker_end = std::min(n, worker_start + chunk);
+            Numa::bindWorker(tid, num_threads);
+            TRACE_SCOPE("query.scan_chunk");
+
+            QuerySink sink(q, wantedHits(q), tid, counters, any, local[tid]);
+            if (worker_start < worker_end) scan(worker_start, worker_end, sink);
+        }
+        return merge(q, local);
+    }
+}
+
+QueryResult PatternMatcher::query(string_view pattern, string_view text, const Query& q) const {
+    TRACE_SCOPE("query.serial");
+    if (q.mode == QueryMode::Count) return {search(pattern, text), {}};
+    return runQuery(text.size(), pattern.size(), q, [&](size_t begin, size_t end, MatchSink& sink) {
+        scanRange(pattern, text, begin, end, sink);
+    });
+}
+
+QueryResult PatternMatcher::queryParallel(string_view pattern, string_view text, const Query& q, int num_threads) const {
+    TRACE_SCOPE("query.parallel");
+    if (q.mode == QueryMode::Count) return {searchParallel(pattern, text, num_threads), {}};
+    return runQueryParallel(name(), text.size(), pattern.size(), q, num_threads, [&](size_t begin, size_t end, MatchSink& sink) {
+        scanRange(pattern, text, begin, end, sink);
+    });
+}
+
+shared_ptr<const CompiledPattern> PatternMatcher::compile(string_view pattern) {
+    return CompiledPattern::compile(pattern);
+}
+
+size_t PatternMatcher::search(const CompiledPattern& pattern, string_view text) const {
+    return searchRange(pattern.forward(), text, 0, text.size());
+}
+
+size_t PatternMatcher::searchParallel(const CompiledPattern& pattern, string_view text, int num_threads) const {
+    TRACE_SCOPE("compiled.search_parallel");
+    return countParallel(*this, pattern.forward(), text, num_threads);
+}
+
+size_t PatternMatcher::searchWithReverseComplement(const CompiledPattern& pattern, string_view text, bool parallel) const {
+    TRACE_SCOPE("compiled.search_rc");
+    if (parallel) {
+        int num_threads = 4;
+        return countParallel(*this, pattern.forward(), text, num_threads) +
+               countParallel(*this, pattern.reverse(), text, num_threads);
+    }
+    return searchRange(pattern.forward(), text, 0, text.size()) + searchRange(pattern.reverse(), text, 0, text.size());
+}
+
+QueryResult PatternMatcher::query(const CompiledPattern& pattern, string_view text, const Query& q) const {
+    TRACE_SCOPE("query.serial");
+    if (q.mode == QueryMode::Count) return {search(pattern, text), {}};
+    return runQuery(text.size(), pattern.size(), q, [&](size_t begin, size_t end, MatchSink& sink) {
+        scanRange(pattern.forward(), text, begin, end, sink);
+    });
+}
+
+QueryResult PatternMatcher::queryParallel(const CompiledPattern& pattern, string_view text, const Query& q, int num_threads) const {
+    TRACE_SCOPE("query.parallel");
+    if (q.mode == QueryMode::Count) return {searchParallel(pattern, text, num_threads), {}};
+    return runQueryParallel(name(), text.size(), pattern.size(), q, num_threads, [&](size_t begin, size_t end, MatchSink& sink) {
+        scanRange(pattern.forward(), text, begin, end, sink);
+    });
+}
@@ -0,0 +1,264 @@
+#include "../../include/QGramBMH.hpp"
+#include "../../include/FastaReader.hpp"
+#include "../../include/BioUtils.hpp"
+#include "../../include/Arena.hpp"
+#include "../../include/Genome.hpp"
+#include "../../include/Calibration.hpp"
+#include "../../include/Numa.hpp"
+#include "../../include/Trace.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <omp.h>
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+using namespace std;
+
+namespace {
+
+    // 2-bit base codes (either case); 4 marks anything that is not A/C/G/T
+    struct BaseCode {
+        uint8_t code[256];
+        BaseCode() {
+            std::fill(std::begin(code), std::end(code), 4);
+            code['A'] = code['a'] = 0;
+            code['C'] = code['c'] = 1;
+            code['G'] = code['g'] = 2;
+            code['T'] = code['t'] = 3;
+        }
+    };
+    const BaseCode BASES;
+
+    // Bucket of the q-gram at p; all grams holding a non-ACGT byte share bucket 4^q
+    inline size_t gramIndex(const char* p, size_t q) {
+        size_t h = 0;
+        uint8_t invalid = 0;
+        for (size_t k = 0; k < q; ++k) {
+            uint8_t c = BASES.code[static_cast<unsigned char>(p[k])];
+            invalid |= c & 4;
+            h = (h << 2) | (c & 3);
+        }
+        return invalid ? (size_t{1} << (2 * q)) : h;
+    }
+
+    inline bool equalsAt(const char* a, const char* b, size_t m) {
+        size_t i = 0;
+#ifdef __AVX2__
+        for (; i + 32 <= m; i += 32) {
+            __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+            __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+            if (static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(x, y))) != 0xFFFFFFFFu)
+                return false;
+        }
+#endif
+        return std::memcmp(a + i, b + i, m - i) == 0;
+    }
+
+    // Counting receiver for the kernels below
+    struct Counter {
+        size_t count = 0;
+        bool onMatch(size_t) { ++count; return true; }
+        bool keepScanning() { return true; }
+    };
+
+    template <typename Sink>
+    void scanGrams(const uint32_t* shift, size_t q, string_view pattern, string_view text,
+                   size_t begin, size_t end, Sink& sink) {
+        const size_t n = text.size(), m = pattern.size();
+        const size_t last_start = std::min(end, n - m + 1);
+        const char* t = text.data();
+        const char* p = pattern.data();
+
+        size_t next_poll = begin;
+        size_t s = begin;
+        while (s < last_start) {
+            if (s >= next_poll) {
+                if (!sink.keepScanning()) return;
+                next_poll = s + MatchSink::POLL_INTERVAL;
+            }
+            size_t h = gramIndex(t + s + m - q, q);
+            // A zero shift marks the pattern's own last q-gram: verify, then step by its
+            // precomputed slide
+            uint32_t d = shift[h];
+            if (d == 0) {
+                if (equalsAt(p, t + s, m) && !sink.onMatch(s)) return;
+                d = shift[(size_t{1} << (2 * q)) + 1];
+            }
+            s += d;
+        }
+    }
+
+    // Fallback for patterns shorter than MIN_Q
+    template <typename Sink>
+    void scanShort(string_view pattern, string_view text, size_t begin, size_t end, Sink& sink) {
+        const size_t n = text.size(), m = pattern.size();
+        const size_t last_start = std::min(end, n - m + 1);
+        for (size_t s = begin; s < last_start; ++s) {
+            if ((s - begin) % MatchSink::POLL_INTERVAL == 0 && !sink.keepScanning()) return;
+            if (text.compare(s, m, pattern) == 0 && !sink.onMatch(s)) return;
+        }
+    }
+
+    size_t countGrams(const uint32_t* shift, size_t q, string_view pattern, string_view text,
+                      size_t begin, size_t end) {
+        Counter counter;
+        if (q == 0) scanShort(pattern, text, begin, end, counter);
+        else scanGrams(shift, q, pattern, text, begin, end, counter);
+        return counter.count;
+    }
+}
+
+size_t QGramBMH::chooseQ(size_t m) {
+    if (m < MIN_Q) return 0;
+    // Roughly log4(m) + 1: enough buckets that pattern grams rarely collide
+    size_t q = static_cast<size_t>(std::bit_width(m) - 1) / 2 + 1;
+    return std::clamp(q, MIN_Q, std::min(MAX_Q, m));
+}
+
+void QGramBMH::buildShiftTable(std::string_view pattern, size_t q, uint32_t* table) {
+    TRACE_SCOPE("qbmh.shift_table");
+    const size_t m = pattern.size();
+    const size_t buckets = size_t{1} << (2 * q);
+    // [0, buckets) valid grams, [buckets] grams with non-ACGT bytes, [buckets + 1] shift after a verify
+    std::fill(table, table + shiftTableSize(q), static_cast<uint32_t>(m - q + 1));
+
+    // Rolling 2-bit hash over the pattern; `invalid` counts non-ACGT bytes in the gram
+    const size_t mask = buckets - 1;
+    size_t h = 0, invalid = 0;
+    for (size_t i = 0; i + 1 < m; ++i) {
+        uint8_t c = BASES.code[static_cast<unsigned char>(pattern[i])];
+        h = ((h << 2) | (c & 3)) & mask;
+        invalid += c >> 2;
+        if (i >= q) invalid -= BASES.code[static_cast<unsigned char>(pattern[i - q])] >> 2;
+        if (i + 1 >= q)
+            table[invalid ? buckets : h] = static_cast<uint32_t>(m - 1 - i);
+    }
+
+    // The last gram's bucket: its shift after verification is what it would have been
+    // without the final gram, i.e. the previous occurrence (or the full slide)
+    size_t last = gramIndex(pattern.data() + m - q, q);
+    table[buckets + 1] = std::max<uint32_t>(1, table[last]);
+    table[last] = 0;
+}
+
+size_t QGramBMH::search(std::string_view pattern, std::string_view text) const {
+    return searchRange(pattern, text, 0, text.size());
+}
+
+size_t QGramBMH::searchRange(std::string_view pattern, std::string_view text, size_t begin, size_t end) const {
+    TRACE_SCOPE("qbmh.scan_range");
+    const size_t n = text.size(), m = pattern.size();
+    end = std::min(end, n);
+    if (m == 0 || n < m || begin >= end) return 0;
+
+    const size_t q = chooseQ(m);
+    if (q == 0) return countGrams(nullptr, 0, pattern, text, begin, end);
+
+    Arena::Scope scratch;
+    std::pmr::vector<uint32_t> shift(shiftTableSize(q), scratch.resource());
+    buildShiftTable(pattern, q, shift.data());
+    return countGrams(shift.data(), q, pattern, text, begin, end);
+}
+
+void QGramBMH::scanRange(std::string_view pattern, std::string_view text, size_t begin, size_t end, MatchSink& sink) const {
+    TRACE_SCOPE("qbmh.scan_query");
+    const size_t n = text.size(), m = pattern.size();
+    end = std::min(end, n);
+    if (m == 0 || n < m || begin >= end) return;
+
+    const size_t q = chooseQ(m);
+    if (q == 0) return scanShort(pattern, text, begin, end, sink);
+
+    Arena::Scope scratch;
+    std::pmr::vector<uint32_t> shift(shiftTableSize(q), scratch.resource());
+    buildShiftTable(pattern, q, shift.data());
+    scanGrams(shift.data(), q, pattern, text, begin, end, sink);
+}
+
+size_t QGramBMH::searchRange(const CompiledStrand& pattern, std::string_view text, size_t begin, size_t end) const {
+    TRACE_SCOPE("qbmh.scan_range");
+    const size_t n = text.size(), m = pattern.size();
+    end = std::min(end, n);
+    if (m == 0 || n < m || begin >= end) return 0;
+    return countGrams(pattern.qgram_shift.data(), pattern.q, pattern.bases, text, begin, end);
+}
+
+void QGramBMH::scanRange(const CompiledStrand& pattern, std::string_view text, size_t begin, size_t end, MatchSink& sink) const {
+    TRACE_SCOPE("qbmh.scan_query");
+    const size_t n = text.size(), m = pattern.size();
+    end = std::min(end, n);
+    if (m == 0 || n < m || begin >= end) return;
+    if (pattern.q == 0) return scanShort(pattern.bases, text, begin, end, sink);
+    scanGrams(pattern.qgram_shift.data(), pattern.q, pattern.bases, text, begin, end, sink);
+}
+
+string_view QGramBMH::name() const {
+    return "qbmh";
+}
+
+size_t QGramBMH::searchInFasta(const string& pattern, const string& fastaPath) const {
+    string dnaSequence = FastaReader::readSequence(fastaPath);
+    return search(pattern, dnaSequence);
+}
+
+size_t QGramBMH::searchParallel(std::string_view pattern, std::string_view text, int num_threads) const {
+    TRACE_SCOPE("qbmh.search_parallel");
+    const size_t n = text.size(), m = pattern.size();
+    if (m == 0 || n < m) return 0;
+    num_threads = Calibration::threadsFor(name(), n, num_threads);
+
+    const size_t q = chooseQ(m);
+    Arena::Scope scratch;
+    std::pmr::vector<uint32_t> shift(scratch.resource());
+    if (q != 0) {
+        shift.resize(shiftTableSize(q));
+        buildShiftTable(pattern, q, shift.data());
+    }
+    size_t total_count = 0;
+
+    #pragma omp parallel num_threads(num_threads) reduction(+: total_count)
+    {
+        int tid = omp_get_thread_num();
+        size_t chunk = (n + num_threads - 1) / num_threads;
+        size_t worker_start = std::min(n, tid * chunk);
+        size_t worker_end = std::min(n, worker_start + chunk);
+        Numa::bindWorker(tid, num_threads);
+        TRACE_SCOPE("qbmh.scan_chunk");
+
+        // Windows starting in [worker_start, worker_end) belong to this worker
+        total_count += countGrams(shift.data(), q, pattern, text, worker_start, worker_end);
+    }
+    return total_count;
+}
+
+size_t QGramBMH::searchParallelInFasta(const std::string& pattern, const std::string& fastaPath) const {
+    int num_threads = 4;
+    auto genome = Genome::load(fastaPath, num_threads);
+    return searchParallel(pattern, genome->view(), num_threads);
+}
+
+size_t QGramBMH::searchWithReverseComplement(std::string_view pattern, std::string_view text, bool parallel) const {
+    TRACE_SCOPE("qbmh.search_rc");
+    Arena::Scope scratch;
+    std::pmr::string rc_pattern = BioUtils::reverseComplement(pattern, scratch.resource());
+
+    if (parallel) {
+        int num_threads = 4;
+        // Run searches sequentially but each uses internal parallelism
+        size_t count_pattern = searchParallel(pattern, text, num_threads);
+        size_t count_rc_pattern = searchParallel(rc_pattern, text, num_threads);
+        return count_pattern + count_rc_pattern;
+    } else {
+        // Sequential version
+        size_t count_pattern = search(pattern, text);
+        size_t count_rc_pattern = search(rc_pattern, text);
+        return count_pattern + count_rc_pattern;
+    }
+}
@@ -0,0 +1,79 @@
+#include "../../include/RegionExecutor.hpp"
+#include "../../include/Trace.hpp"
+
+#include <algorithm>
+#include <omp.h>
+#include <stdexcept>
+
+using namespace std;
+
+RegionExecutor::RegionExecutor(int num_threads, size_t chunk_size)
+    : num_threads(num_threads <= 0 ? 1 : num_threads),
+      chunk_size(chunk_size == 0 ? DEFAULT_CHUNK : chunk_size) {}
+
+const PatternMatcher& RegionExecutor::matcherFor(const string& algorithm) const {
+    if (algorithm == "bmh") return bmh;
+    if (algorithm == "kmp") return kmp;
+    if (algorithm == "bithiftor") return shiftor;
+    if (algorithm == "bndm") return bndm;
+    if (algorithm == "qbmh") return qbmh;
+    throw invalid_argument("Unknown algorithm: " + algorithm +
+                           ". Available: bmh, kmp, bithiftor, bndm, qbmh");
+}
+
+vector<RegionExecutor::Chunk> RegionExecutor::plan(const string& pattern, string_view text) const {
+    TRACE_SCOPE("executor.plan");
+    HybridPicker picker;
+    vector<Chunk> chunks;
+    const size_t n = text.size();
+    for (size_t begin = 0; begin < n; begin += chunk_size) {
+        size_t end = min(n, begin + chunk_size);
+        RegionComposition region = CompositionProfile::profileRegion(text, begin, min(SAMPLE_BYTES, end - begin));
+        chunks.push_back({begin, end, picker.recommendAlgorithm(pattern, region)});
+    }
+    return chunks;
+}
+
+vector<RegionExecutor::Chunk> RegionExecutor::plan(const string& pattern, const Genome& genome) const {
+    HybridPicker picker;
+    const CompositionProfile& profile = genome.profile();
+    vector<Chunk> chunks;
+    const size_t n = genome.size();
+    for (size_t begin = 0; begin < n; begin += chunk_size) {
+        size_t end = min(n, begin + chunk_size);
+        chunks.push_back({begin, end, picker.recommendAlgorithm(pattern, profile.summarize(begin, end))});
+    }
+    return chunks;
+}
+
+size_t RegionExecutor::execute(const string& pattern, string_view text, const vector<Chunk>& chunks) const {
+    TRACE_SCOPE("executor.execute");
+    const size_t m = pattern.size();
+    if (m == 0 || text.size() < m) return 0;
+
+    // Resolve names up front so an unknown engine throws outside the parallel region
+    vector<const PatternMatcher*> engines(chunks.size());
+    for (size_t c = 0; c < chunks.size(); ++c)
+        engines[c] = &matcherFor(chunks[c].algorithm);
+
+    // Every engine's tables are built once here instead of once per chunk
+    auto compiled = PatternMatcher::compile(pattern);
+    size_t total_count = 0;
+    const long long count = static_cast<long long>(chunks.size());
+
+    // Chunks own the matches starting inside them; kernels read m - 1 bases past end
+    #pragma omp parallel for num_threads(num_threads) schedule(dynamic, 1) reduction(+: total_count)
+    for (long long c = 0; c < count; ++c) {
+        const Chunk& chunk = chunks[c];
+        total_count += engines[c]->searchRange(compiled->forward(), text, chunk.begin, chunk.end);
+    }
+    return total_count;
+}
+
+size_t RegionExecutor::search(const string& pattern, string_view text) const {
+    return execute(pattern, text, plan(pattern, text));
+}
+
+size_t RegionExecutor::search(const string& pattern, const Genome& genome) const {
+    return execute(pattern, genome.view(), plan(pattern, genome));
+}
@@ -0,0 +1,154 @@
+#include "../../include/ResultCache.hpp"
+#include "../../include/BioUtils.hpp"
+
+#include <algorithm>
+#include <climits>
+#include <cstdlib>
+#include <functional>
+#include <iterator>
+#include <utility>
+#include <sys/stat.h>
+
+using namespace std;
+
+namespace {
+
+    size_t mix(size_t seed, size_t value) {
+        return seed ^ (value + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2));
+    }
+}
+
+size_t ResultCache::KeyHash::operator()(const Key& k) const {
+    size_t h = hash<string>()(k.pattern);
+    h = mix(h, hash<string>()(k.ref.path));
+    h = mix(h, static_cast<size_t>(k.ref.size));
+    h = mix(h, static_cast<size_t>(k.ref.mtime_ns));
+    h = mix(h, static_cast<size_t>(k.mode));
+    return mix(h, k.limit);
+}
+
+ResultCache::ResultCache(size_t capacity, size_t max_bytes)
+    : max_entries(max<size_t>(1, capacity)), max_bytes(max<size_t>(1, max_bytes)) {}
+
+size_t ResultCache::footprint(const Key& key, const StrandResults& results) {
+    const size_t key_bytes = sizeof(Key) + key.pattern.size() + key.ref.path.size();
+    const size_t positions = results.canonical.positions.size() + results.flipped.positions.size();
+    return 2 * key_bytes + sizeof(StrandResults) + positions * sizeof(size_t) + 4 * sizeof(void*);
+}
+
+optional<ResultCache::ReferenceId> ResultCache::identify(const string& path) {
+    char resolved[PATH_MAX];
+    struct stat st;
+    if (!realpath(path.c_str(), resolved) || stat(resolved, &st) != 0) return nullopt;
+    ReferenceId id;
+    id.path = resolved;
+    id.size = static_cast<uint64_t>(st.st_size);
+    id.mtime_ns = static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000LL + st.st_mtim.tv_nsec;
+    return id;
+}
+
+string ResultCache::canonical(string_view pattern) {
+    string rc = BioUtils::reverseComplement(pattern);
+    // Bytes that do not round-trip through the complement keep the pattern as its own key
+    if (BioUtils::reverseComplement(rc) != pattern) return string(pattern);
+    return pattern <= string_view(rc) ? string(pattern) : rc;
+}
+
+optional<ResultCache::StrandResults> ResultCache::find(const ReferenceId& ref, const string& canonicalPattern,
+                                                       const Query& q) {
+    lock_guard<mutex> guard(lock);
+    observe(ref);
+    auto it = index.find(Key{ref, canonicalPattern, q.mode, q.limit});
+    if (it == index.end()) {
+        ++miss_count;
+        return nullopt;
+    }
+    ++hit_count;
+    entries.splice(entries.begin(), entries, it->second);
+    return it->second->second;
+}
+
+void ResultCache::insert(const ReferenceId& ref, const string& canonicalPattern, const Query& q,
+                         StrandResults results) {
+    Key key{ref, canonicalPattern, q.mode, q.limit};
+    const size_t size = footprint(key, results);
+    if (size > max_bytes / MAX_ENTRY_SHARE) return;
+
+    lock_guard<mutex> guard(lock);
+    observe(ref);
+    auto it = index.find(key);
+    if (it != index.end()) {
+        // Another caller computed the same miss concurrently; keep the newer copy
+        held_bytes -= footprint(it->second->first, it->second->second);
+        it->second->second = std::move(results);
+        entries.splice(entries.begin(), entries, it->second);
+    } else {
+        entries.emplace_front(key, std::move(results));
+        index.emplace(std::move(key), entries.begin());
+    }
+    held_bytes += size;
+    // The newest entry fits on its own, so eviction stops before reaching it
+    while (entries.size() > max_entries || held_bytes > max_bytes) eraseEntry(prev(entries.end()));
+}
+
+list<ResultCache::Entry>::iterator ResultCache::eraseEntry(list<Entry>::iterator it) {
+    held_bytes -= footprint(it->first, it->second);
+    index.erase(it->first);
+    return entries.erase(it);
+}
+
+void ResultCache::observe(const ReferenceId& ref) {
+    auto it = current.find(ref.path);
+    if (it == current.end()) {
+        current.emplace(ref.path, ref);
+    } else if (!(it->second == ref)) {
+        eraseLocked(ref.path);
+        it->second = ref;
+    }
+}
+
+void ResultCache::eraseLocked(const string& path) {
+    for (auto it = entries.begin(); it != entries.end();) {
+        if (it->first.ref.path == path) {
+            it = eraseEntry(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void ResultCache::invalidate(const string& path) {
+    auto id = identify(path);
+    lock_guard<mutex> guard(lock);
+    const string resolved = id ? id->path : path;
+    eraseLocked(resolved);
+    current.erase(resolved);
+}
+
+void ResultCache::clear() {
+    lock_guard<mutex> guard(lock);
+    entries.clear();
+    index.clear();
+    current.clear();
+    held_bytes = 0;
+}
+
+size_t ResultCache::size() const {
+    lock_guard<mutex> guard(lock);
+    return entries.size();
+}
+
+size_t ResultCache::bytes() const {
+    lock_guard<mutex> guard(lock);
+    return held_bytes;
+}
+
+size_t ResultCache::hits() const {
+    lock_guard<mutex> guard(lock);
+    return hit_count;
+}
+
+size_t ResultCache::misses() const {
+    lock_guard<mutex> guard(lock);
+    return miss_count;
+}
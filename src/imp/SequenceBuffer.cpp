@@ -0,0 +1,132 @@
+#include "../../include/SequenceBuffer.hpp"
+#include "../../include/Calibration.hpp"
+#include "../../include/Numa.hpp"
+#include "../../include/Trace.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <new>
+#include <utility>
+#include <omp.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+using namespace std;
+
+static constexpr size_t HUGE_PAGE = size_t{2} << 20; // 2M
+
+namespace {
+
+    size_t roundUp(size_t n, size_t to) {
+        return (n + to - 1) / to * to;
+    }
+
+    /**
+     * Runs fn(begin, end) for chunk tid of the matchers' layout on the worker that
+     * will later scan it. The worker count follows the calibration profile's
+     * engine-independent rule (default chunk, CPU cap); engines whose measured
+     * chunk or bandwidth limit differ scan with fewer workers than placed pages.
+     */
+    template <typename Fn>
+    void forEachChunk(size_t n, int num_threads, Fn&& fn) {
+        num_threads = Calibration::threadsFor({}, n, num_threads);
+        // Page placement needs the Local layout even when scans will not be pinned
+        const Numa::Binding touch = Numa::binding() == Numa::Binding::Off ? Numa::Binding::Off
+                                                                         : Numa::Binding::Local;
+
+        #pragma omp parallel num_threads(num_threads)
+        {
+            int tid = omp_get_thread_num();
+            size_t chunk = (n + num_threads - 1) / num_threads;
+            size_t worker_start = std::min(n, tid * chunk);
+            size_t worker_end = std::min(n, worker_start + chunk);
+
+            Numa::bindWorker(tid, num_threads, touch);
+            TRACE_SCOPE("genome.place_chunk");
+            if (worker_start < worker_end) fn(worker_start, worker_end);
+        }
+    }
+}
+
+SequenceBuffer::~SequenceBuffer() {
+    if (bytes) munmap(bytes, mapped);
+}
+
+SequenceBuffer::SequenceBuffer(SequenceBuffer&& other) noexcept {
+    *this = std::move(other);
+}
+
+SequenceBuffer& SequenceBuffer::operator=(SequenceBuffer&& other) noexcept {
+    if (this == &other) return *this;
+    if (bytes) munmap(bytes, mapped);
+    bytes = std::exchange(other.bytes, nullptr);
+    length = std::exchange(other.length, 0);
+    mapped = std::exchange(other.mapped, 0);
+    page_kind = std::exchange(other.page_kind, Pages::None);
+    return *this;
+}
+
+SequenceBuffer SequenceBuffer::reserve(size_t size) {
+    SequenceBuffer buffer;
+    if (size == 0) return buffer;
+
+    void* p = MAP_FAILED;
+#ifdef MAP_HUGETLB
+    // Explicit huge pages only exist if the admin reserved them; fall through otherwise
+    if (size >= HUGE_PAGE) {
+        buffer.mapped = roundUp(size, HUGE_PAGE);
+        p = mmap(nullptr, buffer.mapped, PROT_READ | PROT_WRITE,
+                 MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (p != MAP_FAILED) buffer.page_kind = Pages::ExplicitHuge;
+    }
+#endif
+    if (p == MAP_FAILED) {
+        buffer.mapped = roundUp(size, static_cast<size_t>(sysconf(_SC_PAGESIZE)));
+        p = mmap(nullptr, buffer.mapped, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (p == MAP_FAILED) throw std::bad_alloc();
+        buffer.page_kind = Pages::Small;
+#ifdef MADV_HUGEPAGE
+        if (size >= HUGE_PAGE && madvise(p, buffer.mapped, MADV_HUGEPAGE) == 0)
+            buffer.page_kind = Pages::TransparentHuge;
+#endif
+    }
+    buffer.bytes = static_cast<char*>(p);
+    buffer.length = size;
+    return buffer;
+}
+
+SequenceBuffer SequenceBuffer::allocate(size_t size, int num_threads) {
+    SequenceBuffer buffer = reserve(size);
+    char* base = buffer.bytes;
+    forEachChunk(size, num_threads, [base](size_t begin, size_t end) {
+        std::memset(base + begin, 0, end - begin);
+    });
+    return buffer;
+}
+
+SequenceBuffer SequenceBuffer::copyOf(string_view text, int num_threads) {
+    return fill(text.size(), num_threads, [text](char* dst, size_t begin, size_t end) {
+        std::memcpy(dst, text.data() + begin, end - begin);
+    });
+}
+
+SequenceBuffer SequenceBuffer::fill(size_t size, int num_threads,
+                                    const std::function<void(char*, size_t, size_t)>& produce) {
+    // Writing the bases is itself the first touch
+    SequenceBuffer buffer = reserve(size);
+    char* base = buffer.bytes;
+    forEachChunk(size, num_threads, [base, &produce](size_t begin, size_t end) {
+        produce(base + begin, begin, end);
+    });
+    return buffer;
+}
+
+const char* SequenceBuffer::pagesName() const {
+    switch (page_kind) {
+        case Pages::None: return "none";
+        case Pages::Small: return "4k";
+        case Pages::TransparentHuge: return "transparent huge (madvise)";
+        case Pages::ExplicitHuge: return "explicit huge (MAP_HUGETLB)";
+    }
+    return "unknown";
+}
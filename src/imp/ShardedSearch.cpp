@@ -0,0 +1,246 @@
+#include "../../include/ShardedSearch.hpp"
+#include "../../include/FastaReader.hpp"
+#include "../../include/GenomeCache.hpp"
+#include "../../include/Numa.hpp"
+#include "../../include/Trace.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <stdexcept>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace std;
+
+namespace {
+
+    // Fixed-size parts of the wire messages; both ends are the same binary
+    // Followed by the engine name, then the pattern
+    struct Request {
+        uint32_t mode;
+        uint32_t algorithm_length;
+        uint64_t limit;
+        uint64_t pattern_length;
+    };
+
+    struct Reply {
+        uint64_t count;
+        uint64_t position_count;
+    };
+
+    bool sendAll(int fd, const void* data, size_t n) {
+        const char* p = static_cast<const char*>(data);
+        while (n > 0) {
+            // MSG_NOSIGNAL: a dead worker is an error to report, not a SIGPIPE
+            ssize_t w = send(fd, p, n, MSG_NOSIGNAL);
+            if (w < 0 && errno == EINTR) continue;
+            if (w <= 0) return false;
+            p += w;
+            n -= static_cast<size_t>(w);
+        }
+        return true;
+    }
+
+    bool recvAll(int fd, void* data, size_t n) {
+        char* p = static_cast<char*>(data);
+        while (n > 0) {
+            ssize_t r = recv(fd, p, n, 0);
+            if (r < 0 && errno == EINTR) continue;
+            if (r <= 0) return false;
+            p += r;
+            n -= static_cast<size_t>(r);
+        }
+        return true;
+    }
+
+    // Collects up to `wanted` positions, shifted from shard to reference coordinates
+    class ShardSink : public MatchSink {
+    public:
+        ShardSink(size_t base, size_t wanted, vector<uint64_t>& positions)
+            : base(base), wanted(wanted), positions(positions) {}
+
+        bool onMatch(size_t pos) override {
+            positions.push_back(base + pos);
+            return positions.size() < wanted;
+        }
+
+    private:
+        size_t base;
+        size_t wanted;
+        vector<uint64_t>& positions;
+    };
+}
+
+/**
+ * Worker process body: serves queries on fd until the coordinator closes it.
+ * The coordinator may have other threads, and any lock one of them held at the
+ * fork stays held here forever, so a worker only decodes its bases and runs
+ * matchers: no tracing, no FASTA reader, no picker (the engine comes with each
+ * query). It also drops a pinned mask inherited from the forking thread.
+ */
+[[noreturn]] static void serveShard(int fd, const GenomeCache* cache, string& whole, const ShardedSearch::Shard& shard,
+                                    size_t load_end) {
+    Trace::disable();
+    Numa::bindWorker(0, 1, Numa::Binding::Off);
+    // Nothing may unwind or exit() into the parent's copy of the stack and atexit handlers
+    try {
+        string local;
+        if (cache) {
+            local.assign(load_end - shard.begin, 'N');
+            cache->decode(local.data(), shard.begin, load_end);
+        } else {
+            local = whole.substr(shard.begin, load_end - shard.begin);
+            // The parent's copy of the whole sequence is no longer needed in this process
+            string().swap(whole);
+        }
+        const size_t owned = shard.end - shard.begin;
+        HybridPicker engines;
+
+        Request req;
+        string algorithm, pattern;
+        vector<uint64_t> positions;
+        while (recvAll(fd, &req, sizeof(req))) {
+            algorithm.resize(req.algorithm_length);
+            pattern.resize(req.pattern_length);
+            if (!recvAll(fd, algorithm.data(), algorithm.size()) || !recvAll(fd, pattern.data(), pattern.size())) break;
+
+            const Query q{static_cast<QueryMode>(req.mode), static_cast<size_t>(req.limit)};
+            const size_t m = pattern.size();
+            // Matches starting in [0, owned) read at most owned + m - 1 bases
+            const string_view text = string_view(local).substr(0, std::min(local.size(), owned + (m ? m - 1 : 0)));
+            auto matcher = engines.createMatcher(algorithm);
+            if (!matcher) break;
+
+            Reply reply{0, 0};
+            positions.clear();
+            if (m != 0 && owned != 0) {
+                if (q.mode == QueryMode::Count) {
+                    reply.count = matcher->searchRange(pattern, text, 0, owned);
+                } else {
+                    const size_t wanted = q.mode == QueryMode::Limit ? q.limit : 1;
+                    if (wanted > 0) {
+                        ShardSink sink(shard.begin, wanted, positions);
+                        matcher->scanRange(pattern, text, 0, owned, sink);
+                    }
+                    reply.count = positions.size();
+                }
+            }
+            reply.position_count = positions.size();
+            if (!sendAll(fd, &reply, sizeof(reply))) break;
+            if (!sendAll(fd, positions.data(), positions.size() * sizeof(uint64_t))) break;
+        }
+    } catch (...) {
+        _exit(1);
+    }
+    close(fd);
+    // Skip the parent's atexit handlers and stdio buffers
+    _exit(0);
+}
+
+ShardedSearch::ShardedSearch(const string& fastaPath, int shards, size_t max_pattern)
+    : max_pattern(max_pattern == 0 ? 1 : max_pattern) {
+    TRACE_SCOPE("shard.launch");
+    if (shards <= 0) shards = 1;
+
+    // Workers decode their shard from the cache mapped here, so nothing is read after the fork.
+    // One parse writes a missing cache; if it cannot be written, workers copy from the parse.
+    optional<GenomeCache> cache = GenomeCache::open(fastaPath);
+    string whole;
+    if (!cache) {
+        vector<GenomeCache::Record> records;
+        whole = FastaReader::parseSequence(fastaPath, &records);
+        if (GenomeCache::write(fastaPath, whole, records) && (cache = GenomeCache::open(fastaPath)))
+            string().swap(whole);
+    }
+    total = cache ? cache->size() : whole.size();
+
+    const size_t n = total;
+    const size_t chunk = (n + shards - 1) / shards;
+    for (int s = 0; s < shards; ++s) {
+        size_t shard_start = std::min(n, s * chunk);
+        size_t shard_end = std::min(n, shard_start + chunk);
+        layout.push_back({shard_start, shard_end});
+    }
+
+    for (const Shard& shard : layout) {
+        int fds[2];
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) {
+            shutdown();
+            throw runtime_error(string("ShardedSearch: socketpair failed: ") + strerror(errno));
+        }
+        pid_t pid = fork();
+        if (pid < 0) {
+            close(fds[0]);
+            close(fds[1]);
+            shutdown();
+            throw runtime_error(string("ShardedSearch: fork failed: ") + strerror(errno));
+        }
+        if (pid == 0) {
+            // Earlier workers' sockets must not stay open here, or they never see EOF
+            for (const Worker& w : workers) close(w.fd);
+            close(fds[0]);
+            serveShard(fds[1], cache ? &*cache : nullptr, whole, shard, std::min(n, shard.end + this->max_pattern - 1));
+        }
+        close(fds[1]);
+        workers.push_back({pid, fds[0]});
+    }
+}
+
+ShardedSearch::~ShardedSearch() {
+    shutdown();
+}
+
+void ShardedSearch::shutdown() {
+    for (Worker& w : workers)
+        if (w.fd >= 0) close(w.fd);
+    for (Worker& w : workers) {
+        int status;
+        while (waitpid(w.pid, &status, 0) < 0 && errno == EINTR) {}
+    }
+    workers.clear();
+}
+
+QueryResult ShardedSearch::query(const string& pattern, const Query& q) {
+    TRACE_SCOPE("shard.query");
+    if (pattern.size() > max_pattern)
+        throw invalid_argument("ShardedSearch: pattern of length " + to_string(pattern.size()) +
+                               " exceeds the shard overlap (max " + to_string(max_pattern) + ")");
+
+    lock_guard<mutex> guard(lock);
+    if (broken) throw runtime_error("ShardedSearch: a worker died earlier; the shards are out of sync");
+    // Any failure below leaves replies unread on the other sockets, so the instance stays broken
+    auto gone = [&](const Worker& w) {
+        broken = true;
+        return runtime_error("ShardedSearch: worker " + to_string(w.pid) + " is gone");
+    };
+
+    // Send to every worker before reading any reply, so the shards search concurrently
+    const string algorithm = picker.recommendAlgorithm(pattern);
+    const Request req{static_cast<uint32_t>(q.mode), static_cast<uint32_t>(algorithm.size()), q.limit, pattern.size()};
+    for (const Worker& w : workers)
+        if (!sendAll(w.fd, &req, sizeof(req)) || !sendAll(w.fd, algorithm.data(), algorithm.size()) ||
+            !sendAll(w.fd, pattern.data(), pattern.size()))
+            throw gone(w);
+
+    QueryResult result;
+    vector<uint64_t> positions;
+    for (const Worker& w : workers) {
+        Reply reply;
+        if (!recvAll(w.fd, &reply, sizeof(reply))) throw gone(w);
+        positions.resize(reply.position_count);
+        if (!recvAll(w.fd, positions.data(), positions.size() * sizeof(uint64_t))) throw gone(w);
+        result.count += reply.count;
+        result.positions.insert(result.positions.end(), positions.begin(), positions.end());
+    }
+
+    if (q.mode != QueryMode::Count) {
+        const size_t wanted = q.mode == QueryMode::Limit ? q.limit : 1;
+        if (result.positions.size() > wanted) result.positions.resize(wanted);
+        result.count = result.positions.size();
+    }
+    return result;
+}
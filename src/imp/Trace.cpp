@@ -0,0 +1,170 @@
+#include "../../include/Trace.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+using namespace std;
+
+namespace {
+
+    struct Event {
+        const char* name;
+        uint64_t start_ns;
+        uint64_t end_ns;
+    };
+
+    // One writer (its thread); ring read only by the dump, which runs when tracing is idle.
+    // clear() and eventCount() may run while the owner records, hence the atomic count
+    struct ThreadBuffer {
+        uint32_t tid = 0;
+        vector<Event> ring;
+        atomic<size_t> written{0};  // total events ever recorded; ring index is written % size
+    };
+
+    struct Registry {
+        mutex lock;
+        vector<shared_ptr<ThreadBuffer>> buffers;
+        size_t capacity = Trace::DEFAULT_CAPACITY;
+        uint64_t epoch_ns = 0;
+    };
+
+    Registry& registry() {
+        static Registry r;
+        return r;
+    }
+
+    ThreadBuffer& localBuffer() {
+        // Owned by the registry too, so events survive the thread
+        thread_local shared_ptr<ThreadBuffer> buffer = [] {
+            Registry& r = registry();
+            auto b = make_shared<ThreadBuffer>();
+            lock_guard<mutex> guard(r.lock);
+            b->tid = static_cast<uint32_t>(r.buffers.size());
+            b->ring.resize(r.capacity);
+            r.buffers.push_back(b);
+            return b;
+        }();
+        return *buffer;
+    }
+
+    string escape(const char* s) {
+        string out;
+        for (; *s; ++s) {
+            if (*s == '"' || *s == '\\') out.push_back('\\');
+            out.push_back(*s);
+        }
+        return out;
+    }
+
+    // DNASEQ_TRACE=<path>: trace the whole process and dump on exit
+    string& exitPath() {
+        static string path;
+        return path;
+    }
+
+    struct EnvActivation {
+        EnvActivation() {
+            const char* path = getenv("DNASEQ_TRACE");
+            if (!path || !*path) return;
+            exitPath() = path;
+            Trace::enable();
+            atexit([] {
+                if (!Trace::writeChromeJson(exitPath()))
+                    fprintf(stderr, "Trace: cannot write %s\n", exitPath().c_str());
+            });
+        }
+    };
+    const EnvActivation env_activation;
+}
+
+namespace Trace {
+
+    namespace detail {
+        atomic<bool> active{false};
+
+        uint64_t nowNs() {
+            return static_cast<uint64_t>(chrono::duration_cast<chrono::nanoseconds>(
+                chrono::steady_clock::now().time_since_epoch()).count());
+        }
+
+        void record(const char* name, uint64_t start_ns, uint64_t end_ns) {
+            ThreadBuffer& b = localBuffer();
+            // An increment, not a store of written + 1, so a concurrent clear() is never undone
+            const size_t slot = b.written.fetch_add(1, memory_order_relaxed);
+            b.ring[slot % b.ring.size()] = {name, start_ns, end_ns};
+        }
+    }
+
+    void enable(size_t events_per_thread) {
+        Registry& r = registry();
+        {
+            lock_guard<mutex> guard(r.lock);
+            r.capacity = events_per_thread == 0 ? 1 : events_per_thread;
+            if (r.epoch_ns == 0) r.epoch_ns = detail::nowNs();
+        }
+        detail::active.store(true, memory_order_relaxed);
+    }
+
+    void disable() {
+        detail::active.store(false, memory_order_relaxed);
+    }
+
+    void clear() {
+        Registry& r = registry();
+        lock_guard<mutex> guard(r.lock);
+        for (auto& b : r.buffers) b->written.store(0, memory_order_relaxed);
+    }
+
+    size_t eventCount() {
+        Registry& r = registry();
+        lock_guard<mutex> guard(r.lock);
+        size_t total = 0;
+        for (auto& b : r.buffers) total += min(b->written.load(memory_order_relaxed), b->ring.size());
+        return total;
+    }
+
+    bool writeChromeJson(const string& path) {
+        Registry& r = registry();
+        lock_guard<mutex> guard(r.lock);
+        ofstream out(path, ios::trunc);
+        if (!out) return false;
+
+        const long pid = static_cast<long>(getpid());
+        out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+        bool first = true;
+        auto separator = [&]() {
+            if (!first) out << ",\n";
+            first = false;
+        };
+        char ts[64];
+        for (auto& b : r.buffers) {
+            separator();
+            out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << pid << ",\"tid\":" << b->tid
+                << ",\"args\":{\"name\":\"thread " << b->tid << "\"}}";
+
+            const size_t written = b->written.load(memory_order_relaxed);
+            const size_t held = min(written, b->ring.size());
+            for (size_t k = written - held; k < written; ++k) {
+                const Event& e = b->ring[k % b->ring.size()];
+                if (e.start_ns < r.epoch_ns) continue;
+                separator();
+                // Microseconds with ns precision, relative to enable()
+                snprintf(ts, sizeof(ts), "\"ts\":%.3f,\"dur\":%.3f",
+                         (e.start_ns - r.epoch_ns) / 1000.0, (e.end_ns - e.start_ns) / 1000.0);
+                out << "{\"name\":\"" << escape(e.name) << "\",\"cat\":\"dnaseq\",\"ph\":\"X\","
+                    << ts << ",\"pid\":" << pid << ",\"tid\":" << b->tid << "}";
+            }
+        }
+        out << "\n]}\n";
+        return static_cast<bool>(out);
+    }
+}
@@ -0,0 +1,90 @@
+// Steady-state searches must not touch the global heap: per-call tables and
+// reverse complements come from the thread-local Arena, and compiled patterns
+// carry theirs.
+
+#include "../../include/Arena.hpp"
+#include "../../include/BM.hpp"
+#include "../../include/Calibration.hpp"
+#include "../../include/KMP.hpp"
+#include "../../include/BP.hpp"
+#include "../../include/BNDM.hpp"
+#include "../../include/QGramBMH.hpp"
+#include "TestUtils.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <random>
+#include <string>
+
+static std::atomic<size_t> heap_allocations{0};
+
+void* operator new(size_t size) {
+    heap_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size) {
+    return ::operator new(size);
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t) noexcept { std::free(p); }
+
+int main() {
+    std::mt19937_64 rng(7);
+    // Chunking must not depend on a calibration file present on the host
+    Calibration::setCurrent({});
+    const std::string text = TestUtils::randomText(rng, size_t{1} << 20, "ACGT");
+    const std::string short_primer = text.substr(4242, 24);
+    const std::string long_primer = text.substr(90000, 700);
+
+    BoyerMooreHorspool bmh;
+    KMP kmp;
+    BitParallelShiftOr shiftor;
+    BNDM bndm;
+    QGramBMH qbmh;
+
+    // Compiled once up front; searching with them must not allocate either
+    const auto compiled_short = PatternMatcher::compile(short_primer);
+    const auto compiled_long = PatternMatcher::compile(long_primer);
+
+    auto batch = [&]() {
+        size_t total = 0;
+        for (const CompiledPattern* p : {compiled_short.get(), compiled_long.get()}) {
+            total += bmh.searchWithReverseComplement(*p, text, false);
+            total += kmp.searchWithReverseComplement(*p, text, false);
+            total += shiftor.searchWithReverseComplement(*p, text, false);
+            total += bndm.searchWithReverseComplement(*p, text, false);
+            total += qbmh.searchWithReverseComplement(*p, text, false);
+        }
+        for (const std::string* p : {&short_primer, &long_primer}) {
+            total += bmh.searchWithReverseComplement(*p, text, false);
+            total += kmp.searchWithReverseComplement(*p, text, false);
+            total += shiftor.searchWithReverseComplement(*p, text, false);
+            total += bndm.searchWithReverseComplement(*p, text, false);
+            total += qbmh.searchWithReverseComplement(*p, text, false);
+            total += bmh.searchParallel(*p, text, 1);
+            total += kmp.searchParallel(*p, text, 1);
+        }
+        return total;
+    };
+
+    // Warm-up: the arena reserves its blocks here
+    size_t warm = batch();
+
+    size_t arena_before = Arena::local().upstreamAllocations();
+    size_t heap_before = heap_allocations.load();
+    for (int i = 0; i < 50; ++i)
+        TestUtils::expectEqual(batch(), warm, "batch result");
+    size_t heap_after = heap_allocations.load();
+
+    TestUtils::expectEqual(heap_after - heap_before, size_t{0}, "heap allocations in steady state");
+    TestUtils::expectEqual(Arena::local().upstreamAllocations() - arena_before, size_t{0},
+                           "arena blocks requested in steady state");
+
+    return TestUtils::finish("AllocationTest");
+}
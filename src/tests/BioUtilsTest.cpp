@@ -0,0 +1,148 @@
+// BioUtils: the vectorized and multi-threaded sequence kernels must agree with
+// plain byte-at-a-time loops on every length around the 32-byte vector width,
+// on lowercase input and on bytes outside ACGTN, including the windowed GC and
+// entropy tracks.
+
+#include "../../include/BioUtils.hpp"
+#include "TestUtils.hpp"
+
+#include <cmath>
+#include <random>
+#include <string>
+#include <vector>
+#include <omp.h>
+
+using namespace std;
+
+namespace {
+
+    // Reference kernels: one byte at a time, no shared code with BioUtils
+
+    char naiveComplement(char c) {
+        const string from = "ACGTacgt", to = "TGCAtgca";
+        size_t k = from.find(c);
+        return k == string::npos ? c : to[k];
+    }
+
+    string naiveReverseComplement(const string& s) {
+        string out;
+        for (size_t i = s.size(); i-- > 0;) out += naiveComplement(s[i]);
+        return out;
+    }
+
+    string naiveUpper(const string& s) {
+        string out = s;
+        for (char& c : out)
+            if (c >= 'a' && c <= 'z') c = static_cast<char>(c - 'a' + 'A');
+        return out;
+    }
+
+    BioUtils::BaseCounts naiveCounts(string_view s) {
+        BioUtils::BaseCounts counts;
+        for (char c : s) {
+            if (c == 'A' || c == 'a') ++counts.a;
+            else if (c == 'C' || c == 'c') ++counts.c;
+            else if (c == 'G' || c == 'g') ++counts.g;
+            else if (c == 'T' || c == 't') ++counts.t;
+        }
+        return counts;
+    }
+
+    double naiveGC(const BioUtils::BaseCounts& k) {
+        const size_t total = k.a + k.c + k.g + k.t;
+        return total == 0 ? 0.0 : static_cast<double>(k.c + k.g) / static_cast<double>(total);
+    }
+
+    double naiveEntropy(const BioUtils::BaseCounts& k) {
+        const double total = static_cast<double>(k.a + k.c + k.g + k.t);
+        double h = 0.0;
+        for (size_t n : {k.a, k.c, k.g, k.t})
+            if (n > 0) h -= n / total * log2(n / total);
+        return h;
+    }
+
+    bool sameCounts(const BioUtils::BaseCounts& x, const BioUtils::BaseCounts& y) {
+        return x.a == y.a && x.c == y.c && x.g == y.g && x.t == y.t;
+    }
+
+    // Any byte value, weighted towards bases of both cases
+    string mixedText(mt19937_64& rng, size_t n) {
+        string s = TestUtils::randomText(rng, n, "ACGTacgtNnRYKMSW-*");
+        for (size_t i = 0; i < n; i += 1 + rng() % 13) s[i] = static_cast<char>(rng() & 0xFF);
+        return s;
+    }
+
+    void checkKernels(const string& s, const string& label) {
+        const string rc = naiveReverseComplement(s);
+        TestUtils::expectEqual(BioUtils::reverseComplement(s) == rc, true, label + " reverseComplement");
+
+        string in_place = s;
+        BioUtils::reverseComplementInPlace(in_place);
+        TestUtils::expectEqual(in_place == rc, true, label + " reverseComplementInPlace");
+
+        const string upper = naiveUpper(s);
+        TestUtils::expectEqual(BioUtils::toUpperCaseDNA(s) == upper, true, label + " toUpperCaseInto");
+        string upper_in_place = s;
+        BioUtils::toUpperCaseDNAInPlace(upper_in_place);
+        TestUtils::expectEqual(upper_in_place == upper, true, label + " toUpperCaseInto aliased");
+
+        TestUtils::expectEqual(sameCounts(BioUtils::countBases(s), naiveCounts(s)), true, label + " countBases");
+    }
+
+    void checkWindows(const string& s, size_t window, size_t step, int threads) {
+        const string label = "window " + to_string(window) + " step " + to_string(step) + " threads " +
+                             to_string(threads) + " n " + to_string(s.size());
+        const auto counts = BioUtils::windowedBaseCounts(s, window, step, threads);
+        const auto gc = BioUtils::windowedGCContent(s, window, step, threads);
+        const auto entropy = BioUtils::windowedShannonEntropy(s, window, step, threads);
+
+        const size_t expected = s.size() < window ? 0 : (s.size() - window) / step + 1;
+        TestUtils::expectEqual(counts.size(), expected, label + " window count");
+        TestUtils::expectEqual(gc.size(), expected, label + " GC track length");
+        TestUtils::expectEqual(entropy.size(), expected, label + " entropy track length");
+        if (counts.size() != expected || gc.size() != expected || entropy.size() != expected) return;
+
+        for (size_t w = 0; w < expected; ++w) {
+            const auto ref = naiveCounts(string_view(s).substr(w * step, window));
+            const string at = label + " at window " + to_string(w);
+            if (!sameCounts(counts[w], ref)) {
+                TestUtils::expectEqual(sameCounts(counts[w], ref), true, at + " counts");
+                return;
+            }
+            if (fabs(gc[w] - naiveGC(ref)) > 1e-12 || fabs(entropy[w] - naiveEntropy(ref)) > 1e-12) {
+                TestUtils::expectEqual(gc[w], naiveGC(ref), at + " GC");
+                TestUtils::expectEqual(entropy[w], naiveEntropy(ref), at + " entropy");
+                return;
+            }
+        }
+    }
+
+} // namespace
+
+int main() {
+    // The kernels size their team from omp_get_max_threads; force a split even on one CPU
+    omp_set_num_threads(4);
+    mt19937_64 rng(27);
+
+    // Every length across the first vectors' heads and tails, then odd sizes past them
+    for (size_t n = 0; n <= 130; ++n) checkKernels(mixedText(rng, n), "n " + to_string(n));
+    for (size_t n : {255, 256, 257, 1023, 4097, 65537}) checkKernels(mixedText(rng, n), "n " + to_string(n));
+    checkKernels(string(97, 'a') + "\x80\xff\x7f@[`{" + string(33, 'T'), "boundary bytes");
+
+    // Large enough that the kernels split across threads (ranges aligned to 32, odd total)
+    const string large = mixedText(rng, (size_t{1} << 22) + 4099);
+    checkKernels(large, "multi-threaded");
+
+    const string seq = mixedText(rng, 3001);
+    for (size_t window : {1, 31, 32, 33, 100})
+        for (size_t step : {1, 7, 32, 33, 150})
+            for (int threads : {1, 3}) checkWindows(seq, window, step, threads);
+    checkWindows(seq, 5000, 1, 2);
+
+    // windows * window past the parallel threshold, so each worker slides its own run
+    const string track = mixedText(rng, (size_t{1} << 20) + 17);
+    checkWindows(track, 64, 8, 4);
+    checkWindows(track, 1001, 999, 3);
+
+    return TestUtils::finish("BioUtilsTest");
+}
@@ -0,0 +1,150 @@
+// Calibration: threadsFor must honour every cap of the profile, a saved
+// profile must load back unchanged, malformed files must be rejected, the
+// engines must scan with the worker count the active profile picks, and the
+// picker must route to qbmh only on a multi-core profile that measured it faster.
+
+#include "../../include/BM.hpp"
+#include "../../include/Calibration.hpp"
+#include "../../include/HybridPicker.hpp"
+#include "../../include/Trace.hpp"
+#include "TestUtils.hpp"
+
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <string>
+
+using namespace std;
+
+namespace {
+
+    // Workers that ran a bmh.scan_chunk span during one traced parallel search
+    size_t tracedWorkers(const BoyerMooreHorspool& bmh, const string& pattern, const string& text, int threads,
+                         size_t& matches) {
+        Trace::clear();
+        Trace::enable();
+        matches = bmh.searchParallel(pattern, text, threads);
+        Trace::disable();
+
+        const string path = "build/CalibrationTest.json";
+        Trace::writeChromeJson(path);
+        ifstream in(path);
+        stringstream json;
+        json << in.rdbuf();
+        remove(path.c_str());
+
+        size_t spans = 0;
+        const string body = json.str();
+        for (size_t at = body.find("bmh.scan_chunk"); at != string::npos; at = body.find("bmh.scan_chunk", at + 1)) ++spans;
+        return spans;
+    }
+
+} // namespace
+
+int main() {
+    using Calibration::Profile;
+
+    // Uncalibrated: 64k bases per worker, nothing else
+    Profile plain;
+    TestUtils::expectEqual(plain.calibrated(), false, "default profile is uncalibrated");
+    TestUtils::expectEqual(plain.minChunk("bmh"), Calibration::DEFAULT_MIN_CHUNK, "default chunk");
+    TestUtils::expectEqual(plain.threadsFor("bmh", size_t{1} << 20, 4), 4, "large text keeps requested threads");
+    TestUtils::expectEqual(plain.threadsFor("bmh", 100000, 4), 1, "one chunk's worth runs serially");
+    TestUtils::expectEqual(plain.threadsFor("bmh", 200000, 4), 3, "threads limited to whole chunks");
+    TestUtils::expectEqual(plain.threadsFor("bmh", size_t{1} << 20, 0), 1, "non-positive request means one thread");
+    TestUtils::expectEqual(plain.threadsFor("bmh", 10, 4), 1, "tiny text");
+
+    Profile host;
+    host.hardware_threads = 8;
+    host.bandwidth = 10e9;
+    host.fork_join_seconds = 5e-6;
+    host.engines["bmh"] = {4e9, size_t{1} << 14};
+    host.engines["kmp"] = {1e9, size_t{1} << 18};
+    TestUtils::expectEqual(host.calibrated(), true, "measured profile is calibrated");
+    TestUtils::expectEqual(host.threadsFor("bmh", size_t{1} << 30, 16), 3, "bmh saturates bandwidth at 3 workers");
+    TestUtils::expectEqual(host.threadsFor("kmp", size_t{1} << 30, 16), 8, "kmp capped by CPU count");
+    TestUtils::expectEqual(host.threadsFor("kmp", size_t{1} << 19, 16), 2, "kmp measured chunk");
+    TestUtils::expectEqual(host.threadsFor("bmh", size_t{1} << 15, 16), 2, "bmh measured chunk");
+    TestUtils::expectEqual(host.threadsFor("bndm", size_t{1} << 30, 16), 8, "unmeasured engine: CPU cap only");
+    TestUtils::expectEqual(host.minChunk("bndm"), Calibration::DEFAULT_MIN_CHUNK, "unmeasured engine chunk");
+
+    // Round trip, then files that must not load
+    const string path = "build/CalibrationTest.txt";
+    TestUtils::expectEqual(Calibration::save(host, path), true, "profile saved");
+    auto loaded = Calibration::load(path);
+    TestUtils::expectEqual(loaded.has_value(), true, "profile loads");
+    if (loaded) {
+        TestUtils::expectEqual(loaded->hardware_threads, host.hardware_threads, "loaded hardware threads");
+        TestUtils::expectEqual(loaded->bandwidth, host.bandwidth, "loaded bandwidth");
+        TestUtils::expectEqual(loaded->fork_join_seconds, host.fork_join_seconds, "loaded fork/join");
+        TestUtils::expectEqual(loaded->engines.size(), size_t{2}, "loaded engines");
+        TestUtils::expectEqual(loaded->engines["bmh"].bytes_per_second, 4e9, "loaded bmh rate");
+        TestUtils::expectEqual(loaded->minChunk("kmp"), size_t{1} << 18, "loaded kmp chunk");
+    }
+    {
+        ofstream out(path, ios::trunc);
+        out << "dnaseq_calibration 1\nhardware_threads eight\n";
+    }
+    TestUtils::expectEqual(Calibration::load(path).has_value(), false, "malformed profile rejected");
+    {
+        ofstream out(path, ios::trunc);
+        out << "dnaseq_calibration 99\nhardware_threads 8\n";
+    }
+    TestUtils::expectEqual(Calibration::load(path).has_value(), false, "unknown version rejected");
+    remove(path.c_str());
+    TestUtils::expectEqual(Calibration::load(path).has_value(), false, "missing profile");
+
+    // A quick measurement produces a usable profile
+    Profile measured = Calibration::measure(size_t{1} << 20);
+    TestUtils::expectEqual(measured.calibrated(), true, "measure sets hardware threads");
+    TestUtils::expectEqual(measured.bandwidth > 0, true, "measured bandwidth");
+    TestUtils::expectEqual(measured.engines.size(), size_t{5}, "every engine measured");
+    for (const auto& [name, rate] : measured.engines) {
+        TestUtils::expectEqual(rate.bytes_per_second > 0, true, name + " rate");
+        TestUtils::expectEqual(rate.min_chunk >= 4096, true, name + " chunk floor");
+    }
+
+    // Engines follow the active profile
+    mt19937_64 rng(43);
+    const string text = TestUtils::randomText(rng, size_t{1} << 20, "ACGT");
+    const string pattern = text.substr(54321, 24);
+    const size_t expected = TestUtils::naiveCount(pattern, text);
+    BoyerMooreHorspool bmh;
+    size_t matches = 0;
+
+    Calibration::setCurrent(plain);
+    TestUtils::expectEqual(tracedWorkers(bmh, pattern, text, 4, matches), size_t{4}, "default profile: 4 workers");
+    TestUtils::expectEqual(matches, expected, "default profile count");
+
+    Profile serial = host;
+    serial.engines["bmh"].min_chunk = text.size();
+    Calibration::setCurrent(serial);
+    TestUtils::expectEqual(tracedWorkers(bmh, pattern, text, 4, matches), size_t{1}, "chunk as large as the text: 1 worker");
+    TestUtils::expectEqual(matches, expected, "serial profile count");
+
+    Calibration::setCurrent(host);
+    TestUtils::expectEqual(tracedWorkers(bmh, pattern, text, 16, matches), size_t{3}, "bandwidth cap: 3 workers");
+    TestUtils::expectEqual(matches, expected, "bandwidth-capped count");
+
+    // qbmh is only picked where a multi-core calibration measured it faster than the tree's engine
+    HybridPicker picker;
+    const string primer = text.substr(1000, 200);
+    Calibration::setCurrent(plain);
+    TestUtils::expectEqual(picker.recommendAlgorithm(primer), string("bndm"), "uncalibrated: tree pick");
+    Profile quick = host;
+    quick.engines["bndm"] = {2e9, size_t{1} << 16};
+    quick.engines["qbmh"] = {3e9, size_t{1} << 16};
+    Calibration::setCurrent(quick);
+    TestUtils::expectEqual(picker.recommendAlgorithm(primer), string("qbmh"), "measured faster: qbmh");
+    quick.hardware_threads = 1;
+    Calibration::setCurrent(quick);
+    TestUtils::expectEqual(picker.recommendAlgorithm(primer), string("bndm"), "single-core profile: tree pick");
+    quick.hardware_threads = 8;
+    quick.engines["qbmh"].bytes_per_second = 1e9;
+    Calibration::setCurrent(quick);
+    TestUtils::expectEqual(picker.recommendAlgorithm(primer), string("bndm"), "measured slower: tree pick");
+
+    Calibration::setCurrent(plain);
+    return TestUtils::finish("CalibrationTest");
+}
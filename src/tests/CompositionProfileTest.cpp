@@ -0,0 +1,37 @@
+// Composition profile: tiles must cover the text in window steps, at() must
+// clamp to the last tile and return an empty region for an empty text, and
+// summarize() must add up the tiles it spans.
+
+#include "../../include/CompositionProfile.hpp"
+#include "TestUtils.hpp"
+
+#include <random>
+#include <string>
+
+using namespace std;
+
+int main() {
+    // Empty text: no tiles, and lookups must not index past them
+    CompositionProfile empty = CompositionProfile::compute("", 1000, 4);
+    TestUtils::expectEqual(empty.windows().size(), size_t{0}, "empty text has no tiles");
+    TestUtils::expectEqual(empty.at(0).length, size_t{0}, "empty text: at(0) is an empty region");
+    TestUtils::expectEqual(empty.at(12345).counts.acgt(), size_t{0}, "empty text: at past the end");
+    TestUtils::expectEqual(empty.summarize(0, 100).length, size_t{0}, "empty text: summary");
+    TestUtils::expectEqual(CompositionProfile().at(7).length, size_t{0}, "default profile: at");
+
+    mt19937_64 rng(28);
+    const string text = TestUtils::randomText(rng, 10007, "ACGTN");
+    CompositionProfile profile = CompositionProfile::compute(text, 1000, 4);
+    TestUtils::expectEqual(profile.windows().size(), size_t{11}, "tile count rounds up");
+    TestUtils::expectEqual(profile.windows().back().length, size_t{7}, "short last tile");
+    TestUtils::expectEqual(profile.at(4321).start, size_t{4000}, "at finds the containing tile");
+    TestUtils::expectEqual(profile.at(text.size() + 5000).start, size_t{10000}, "at clamps to the last tile");
+
+    const RegionComposition whole = profile.summarize(0, text.size());
+    const RegionComposition direct = CompositionProfile::profileRegion(text, 0, text.size());
+    TestUtils::expectEqual(whole.length, text.size(), "summary spans the text");
+    TestUtils::expectEqual(whole.counts.acgt(), direct.counts.acgt(), "summary base counts");
+    TestUtils::expectEqual(whole.counts.gc(), direct.counts.gc(), "summary GC counts");
+
+    return TestUtils::finish("CompositionProfileTest");
+}
@@ -0,0 +1,170 @@
+// Differential test: every engine, serial vs parallel vs reverse complement,
+// against a naive reference. Texts are large enough that the parallel paths
+// really split into num_threads chunks, so chunk boundaries are exercised.
+// Early-exit queries must agree with the naive positions in every mode, and a
+// compiled pattern must give the same answers as the string entry points.
+
+#include "../../include/BM.hpp"
+#include "../../include/KMP.hpp"
+#include "../../include/BP.hpp"
+#include "../../include/BNDM.hpp"
+#include "../../include/QGramBMH.hpp"
+#include "../../include/BioUtils.hpp"
+#include "../../include/Calibration.hpp"
+#include "../../include/RegionExecutor.hpp"
+#include "TestUtils.hpp"
+
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+    struct Engine {
+        string name;
+        unique_ptr<PatternMatcher> matcher;
+        size_t max_pattern;  // longer patterns are documented to return 0
+    };
+
+    vector<Engine> engines() {
+        vector<Engine> list;
+        list.push_back({"bmh", make_unique<BoyerMooreHorspool>(), SIZE_MAX});
+        list.push_back({"kmp", make_unique<KMP>(), SIZE_MAX});
+        list.push_back({"bithiftor", make_unique<BitParallelShiftOr>(), 64});
+        list.push_back({"bndm", make_unique<BNDM>(), SIZE_MAX});
+        list.push_back({"qbmh", make_unique<QGramBMH>(), SIZE_MAX});
+        return list;
+    }
+
+    // Patterns drawn from the text (guaranteed hits) plus random ones, at lengths
+    // straddling the shift-or word size and the chunk boundaries
+    vector<string> patternsFor(mt19937_64& rng, const string& text) {
+        vector<string> patterns = {"A", "N", "AC", "TTT", "ANA", "NNNN", "ACGTACGT", "acgt", "ACGTNNACGT"};
+        const size_t lengths[] = {1, 2, 3, 5, 8, 16, 31, 32, 33, 63, 64, 65, 100, 257, 1000};
+        uniform_int_distribution<size_t> pos(0, text.size() - 1);
+        for (size_t m : lengths) {
+            if (m > text.size()) continue;
+            size_t s = min(pos(rng), text.size() - m);
+            patterns.push_back(text.substr(s, m));
+            patterns.push_back(TestUtils::randomText(rng, m, "ACGT"));
+        }
+        return patterns;
+    }
+
+    vector<size_t> prefix(const vector<size_t>& hits, size_t n) {
+        return vector<size_t>(hits.begin(), hits.begin() + min(n, hits.size()));
+    }
+
+    void checkQuery(const QueryResult& got, const vector<size_t>& want, const string& what) {
+        TestUtils::expectEqual(got.count, want.size(), what + " count");
+        TestUtils::expectEqual(got.positions == want, true, what + " positions");
+    }
+
+    void checkQueries(const Engine& e, const string& pattern, const string& text,
+                      const vector<size_t>& hits, const string& what) {
+        const int thread_counts[] = {1, 3, 8};
+        const size_t limits[] = {1, 10, SIZE_MAX};
+
+        for (int t : thread_counts) {
+            auto run = [&](const Query& q) {
+                return t == 1 ? e.matcher->query(pattern, text, q) : e.matcher->queryParallel(pattern, text, q, t);
+            };
+            const string how = e.name + " query x" + to_string(t) + " " + what;
+
+            QueryResult exists = run(Query::exists());
+            TestUtils::expectEqual(exists.found(), !hits.empty(), how + " exists");
+            if (exists.found()) {
+                TestUtils::expectEqual(exists.count, size_t{1}, how + " exists count");
+                TestUtils::expectEqual(text.compare(exists.positions[0], pattern.size(), pattern), 0,
+                                       how + " exists position");
+            }
+            checkQuery(run(Query::first()), prefix(hits, 1), how + " first");
+            for (size_t limit : limits)
+                checkQuery(run(Query::firstN(limit)), prefix(hits, limit), how + " limit " + to_string(limit));
+            TestUtils::expectEqual(run(Query::count()).count, hits.size(), how + " count mode");
+        }
+    }
+
+    void checkText(const string& label, const string& text, const vector<string>& patterns) {
+        const int thread_counts[] = {1, 2, 3, 4, 5, 7, 8};
+        auto list = engines();
+
+        for (const string& pattern : patterns) {
+            const size_t m = pattern.size();
+            const vector<size_t> hits = TestUtils::naivePositions(pattern, text);
+            const size_t expected = hits.size();
+            const size_t expected_rc = expected + TestUtils::naiveCount(BioUtils::reverseComplement(pattern), text);
+            const string what = label + " m=" + to_string(m);
+            const auto compiled = PatternMatcher::compile(pattern);
+            TestUtils::expectEqual(compiled->reverse().bases == BioUtils::reverseComplement(pattern), true,
+                                   "compiled reverse strand " + what);
+
+            for (const Engine& e : list) {
+                const bool supported = m <= e.max_pattern;
+                const size_t want = supported ? expected : 0;
+                const size_t want_rc = supported ? expected_rc : 0;
+
+                TestUtils::expectEqual(e.matcher->search(pattern, text), want, e.name + " serial " + what);
+                for (int t : thread_counts)
+                    TestUtils::expectEqual(e.matcher->searchParallel(pattern, text, t), want,
+                                           e.name + " parallel x" + to_string(t) + " " + what);
+                TestUtils::expectEqual(e.matcher->searchWithReverseComplement(pattern, text, false), want_rc,
+                                       e.name + " serial+rc " + what);
+                TestUtils::expectEqual(e.matcher->searchWithReverseComplement(pattern, text, true), want_rc,
+                                       e.name + " parallel+rc " + what);
+                checkQueries(e, pattern, text, supported ? hits : vector<size_t>{}, what);
+
+                // One compiled pattern shared by every call must answer exactly like the string path
+                TestUtils::expectEqual(e.matcher->search(*compiled, text), want, e.name + " compiled " + what);
+                for (int t : {3, 8})
+                    TestUtils::expectEqual(e.matcher->searchParallel(*compiled, text, t), want,
+                                           e.name + " compiled x" + to_string(t) + " " + what);
+                TestUtils::expectEqual(e.matcher->searchWithReverseComplement(*compiled, text, false), want_rc,
+                                       e.name + " compiled serial+rc " + what);
+                TestUtils::expectEqual(e.matcher->searchWithReverseComplement(*compiled, text, true), want_rc,
+                                       e.name + " compiled parallel+rc " + what);
+                checkQuery(e.matcher->query(*compiled, text, Query::firstN(10)),
+                           prefix(supported ? hits : vector<size_t>{}, 10), e.name + " compiled limit 10 " + what);
+                checkQuery(e.matcher->queryParallel(*compiled, text, Query::first(), 5),
+                           prefix(supported ? hits : vector<size_t>{}, 1), e.name + " compiled x5 first " + what);
+            }
+
+            for (size_t chunk : {size_t{1} << 12, RegionExecutor::DEFAULT_CHUNK}) {
+                RegionExecutor executor(4, chunk);
+                TestUtils::expectEqual(executor.search(pattern, text), expected,
+                                       "adaptive chunk=" + to_string(chunk) + " " + what);
+            }
+        }
+    }
+}
+
+int main() {
+    mt19937_64 rng(20261018);
+    // Chunking must not depend on a calibration file present on the host
+    Calibration::setCurrent({});
+    // 8 threads x 64k is the smallest text for which every thread count really splits
+    const size_t n = (size_t{8} << 16) + 12345;
+
+    string uniform = TestUtils::randomText(rng, n, "ACGT");
+    string at_rich = TestUtils::randomText(rng, n, "AAAATTTTCG");
+    string n_rich = TestUtils::randomText(rng, n, "ACGT", 0.01);
+    string repeats;
+    while (repeats.size() < n) repeats += "ATATATATATATATATATAT" + string(50, 'A') + "CAG";
+    repeats.resize(n);
+
+    checkText("uniform", uniform, patternsFor(rng, uniform));
+    checkText("at_rich", at_rich, patternsFor(rng, at_rich));
+    checkText("n_rich", n_rich, patternsFor(rng, n_rich));
+    checkText("repeats", repeats, patternsFor(rng, repeats));
+
+    // Pattern longer than a whole parallel chunk, and pattern == text
+    string small = TestUtils::randomText(rng, size_t{4} << 16, "ACGT");
+    checkText("m>chunk", small, {small.substr(1000, 70000), small.substr(0, small.size() - 1)});
+    checkText("m==n", small, {small, small + "A"});
+    checkText("tiny", "ACGTN", {"ACGTN", "A", "CGT", "ACGTNA"});
+
+    return TestUtils::finish("DifferentialTest");
+}
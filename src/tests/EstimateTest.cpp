@@ -0,0 +1,110 @@
+// Sampled count estimation: the interval must cover the exact count at about
+// its nominal rate, an error target must be met (or the scan become exact),
+// sampling every chunk must return the exact count, the zero-hit bound must
+// follow opts.z, and a FASTA estimate (with or without its binary cache) must
+// equal the in-memory one for the same seed.
+
+#include "../../include/GenomeCache.hpp"
+#include "../../include/HybridPicker.hpp"
+#include "TestUtils.hpp"
+
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <string>
+
+using namespace std;
+
+int main() {
+    mt19937_64 rng(41);
+    // Uneven density: a GC-rich middle third changes the local hit rate
+    string text = TestUtils::randomText(rng, 3 << 20, "ACGT", 0.0002);
+    string rich = TestUtils::randomText(rng, 1 << 20, "GGCCGCAT");
+    text.replace(text.size() / 3, rich.size(), rich);
+
+    HybridPicker picker;
+    const string pattern = "GCCGC";
+    const size_t exact = TestUtils::naiveCount(pattern, text);
+
+    int covered = 0;
+    const int trials = 40;
+    for (int t = 0; t < trials; ++t) {
+        EstimateOptions opts;
+        opts.chunk_size = 1 << 14;
+        opts.sample_fraction = 0.05;
+        opts.seed = 1000 + t;
+        CountEstimate est = picker.estimateCount(pattern, text, opts);
+        if (est.low <= exact && exact <= est.high) ++covered;
+        TestUtils::expectEqual(est.chunks_sampled >= est.chunks_total / 20, true, "minimum sample, seed " + to_string(t));
+    }
+    // 95% nominal; allow for the normal approximation and 40 trials
+    TestUtils::expectEqual(covered >= 33, true, "interval coverage " + to_string(covered) + "/" + to_string(trials));
+
+    EstimateOptions precise;
+    precise.chunk_size = 1 << 14;
+    precise.target_relative_error = 0.02;
+    precise.seed = 7;
+    CountEstimate est = picker.estimateCount(pattern, text, precise);
+    TestUtils::expectEqual(est.relative_error <= 0.02, true, "target relative error met");
+    TestUtils::expectEqual(est.chunks_sampled < est.chunks_total, true, "target met before a full scan");
+
+    EstimateOptions budget;
+    budget.chunk_size = 1 << 14;
+    budget.time_budget_ms = 1;
+    budget.seed = 9;
+    est = picker.estimateCount(pattern, text, budget);
+    TestUtils::expectEqual(est.chunks_sampled > 0, true, "time budget still samples");
+
+    EstimateOptions full;
+    full.sample_fraction = 1.0;
+    full.seed = 3;
+    est = picker.estimateCount(pattern, text, full);
+    TestUtils::expectEqual(est.exact, true, "full sample is exact");
+    TestUtils::expectEqual(static_cast<size_t>(est.count), exact, "full sample count");
+    TestUtils::expectEqual(est.low == est.high, true, "exact interval is a point");
+
+    // A pattern absent from the sample still gets a non-zero upper bound
+    est = picker.estimateCount(string(40, 'T'), text, EstimateOptions{});
+    TestUtils::expectEqual(est.count, 0.0, "absent pattern estimate");
+    TestUtils::expectEqual(est.high > 0, true, "absent pattern upper bound");
+
+    // The zero-hit bound is -ln(alpha) per sampled chunk: the rule of three at z = 1.96
+    for (const auto& [z, per_chunk] : {pair{1.96, 2.9957}, pair{2.5758, 4.6052}}) {
+        EstimateOptions absent;
+        absent.z = z;
+        absent.seed = 5;
+        est = picker.estimateCount(string(40, 'T'), text, absent);
+        const double bound = est.high * static_cast<double>(est.chunks_sampled) / static_cast<double>(est.chunks_total);
+        TestUtils::expectEqual(fabs(bound - per_chunk) < 1e-3, true, "zero-hit bound at z " + to_string(z));
+    }
+
+    // FASTA estimates decode only the sampled chunks, from a cache written on first use
+    const string path = "build/EstimateTest.fa";
+    {
+        ofstream out(path, ios::binary | ios::trunc);
+        out << ">chr1\n";
+        for (size_t i = 0; i < text.size(); i += 60) out << text.substr(i, 60) << '\n';
+    }
+    remove(GenomeCache::cachePath(path).c_str());
+    EstimateOptions sampled;
+    sampled.chunk_size = 1 << 14;
+    sampled.sample_fraction = 0.05;
+    sampled.seed = 11;
+    const CountEstimate in_memory = picker.estimateCount(pattern, text, sampled);
+    for (const string run : {"without a cache", "from the cache"}) {
+        const CountEstimate from_fasta = picker.estimateCountInFasta(pattern, path, sampled);
+        TestUtils::expectEqual(from_fasta.count, in_memory.count, "FASTA estimate " + run);
+        TestUtils::expectEqual(from_fasta.high, in_memory.high, "FASTA upper bound " + run);
+        TestUtils::expectEqual(from_fasta.chunks_sampled, in_memory.chunks_sampled, "FASTA sample " + run);
+    }
+    est = picker.estimateCountInFasta(pattern, path, full);
+    TestUtils::expectEqual(static_cast<size_t>(est.count), exact, "FASTA full sample count");
+    remove(path.c_str());
+    remove(GenomeCache::cachePath(path).c_str());
+
+    est = picker.estimateCount("ACGT", "ACG");
+    TestUtils::expectEqual(est.exact && est.count == 0, true, "text shorter than pattern");
+
+    return TestUtils::finish("EstimateTest");
+}
@@ -0,0 +1,116 @@
+// Fuzz harness: decodes a byte string into (pattern, text, threads) and checks
+// every engine against the naive reference. Fuzz texts are a few hundred bases,
+// so the harness installs a calibration profile with one-base chunks: every
+// parallel call really splits into its requested thread count.
+//
+//   clang++ -fsanitize=fuzzer,address -DDNASEQ_LIBFUZZER ...   -> libFuzzer target
+//   make fuzz                                                   -> standalone random driver
+
+#include "../../include/BM.hpp"
+#include "../../include/KMP.hpp"
+#include "../../include/BP.hpp"
+#include "../../include/BNDM.hpp"
+#include "../../include/QGramBMH.hpp"
+#include "../../include/BioUtils.hpp"
+#include "../../include/Calibration.hpp"
+#include "../../include/RegionExecutor.hpp"
+#include "TestUtils.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <initializer_list>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// Without it, the default 64k bases per worker would keep every fuzz input on one thread
+static bool installTinyChunks() {
+    const BoyerMooreHorspool bmh;
+    const KMP kmp;
+    const BitParallelShiftOr shiftor;
+    const BNDM bndm;
+    const QGramBMH qbmh;
+    Calibration::Profile profile;
+    for (const PatternMatcher* engine : initializer_list<const PatternMatcher*>{&bmh, &kmp, &shiftor, &bndm, &qbmh})
+        profile.engines[string(engine->name())].min_chunk = 1;
+    Calibration::setCurrent(profile);
+    return true;
+}
+
+static void checkInput(const uint8_t* data, size_t size) {
+    static const bool tiny_chunks = installTinyChunks();
+    (void)tiny_chunks;
+    if (size < 2) return;
+    // Byte 0: pattern length, byte 1: thread count, rest: text over ACGTN plus a lower-case base
+    static const char alphabet[] = "ACGTNa";
+    const size_t m = data[0] % 80 + 1;
+    const int threads = data[1] % 8 + 1;
+    string decoded(size - 2, 'A');
+    for (size_t i = 2; i < size; ++i) decoded[i - 2] = alphabet[data[i] % 6];
+    if (decoded.size() < m) return;
+
+    const string pattern = decoded.substr(0, m);
+    const string text = decoded.substr(m);
+    const size_t expected = TestUtils::naiveCount(pattern, text);
+    const size_t expected_rc = expected + TestUtils::naiveCount(BioUtils::reverseComplement(pattern), text);
+
+    BoyerMooreHorspool bmh;
+    KMP kmp;
+    BitParallelShiftOr shiftor;
+    BNDM bndm;
+    QGramBMH qbmh;
+    const size_t want_bp = m <= 64 ? expected : 0;
+
+    // One-base chunks: every text of at least `threads` bases splits that many ways
+    const int split = static_cast<int>(min<size_t>(threads, max<size_t>(1, text.size())));
+
+    bool ok = Calibration::threadsFor(bmh.name(), text.size(), threads) == split &&
+              bmh.search(pattern, text) == expected &&
+              kmp.search(pattern, text) == expected &&
+              shiftor.search(pattern, text) == want_bp &&
+              bmh.searchParallel(pattern, text, threads) == expected &&
+              kmp.searchParallel(pattern, text, threads) == expected &&
+              shiftor.searchParallel(pattern, text, threads) == want_bp &&
+              bndm.search(pattern, text) == expected &&
+              bndm.searchParallel(pattern, text, threads) == expected &&
+              bndm.searchWithReverseComplement(pattern, text, false) == expected_rc &&
+              qbmh.search(pattern, text) == expected &&
+              qbmh.searchParallel(pattern, text, threads) == expected &&
+              qbmh.searchWithReverseComplement(pattern, text, true) == expected_rc &&
+              bmh.searchWithReverseComplement(pattern, text, false) == expected_rc &&
+              kmp.searchWithReverseComplement(pattern, text, true) == expected_rc &&
+              RegionExecutor(threads, m + threads).search(pattern, text) == expected;
+    if (!ok) {
+        cerr << "Mismatch for pattern " << pattern << " on text of length " << text.size() << "\n";
+        abort();
+    }
+}
+
+#ifdef DNASEQ_LIBFUZZER
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    checkInput(data, size);
+    return 0;
+}
+#else
+int main(int argc, char** argv) {
+    const int iterations = argc > 1 ? atoi(argv[1]) : 20000;
+    mt19937_64 rng(argc > 2 ? strtoull(argv[2], nullptr, 10) : 1);
+    uniform_int_distribution<size_t> length(2, 600);
+    uniform_int_distribution<int> byte(0, 255);
+
+    vector<uint8_t> input;
+    for (int it = 0; it < iterations; ++it) {
+        input.resize(length(rng));
+        for (uint8_t& b : input) b = static_cast<uint8_t>(byte(rng));
+        // Bias half of the inputs towards a 2-letter alphabet so matches are frequent
+        if (it % 2 == 0)
+            for (size_t i = 2; i < input.size(); ++i) input[i] %= 2;
+        checkInput(input.data(), input.size());
+    }
+    cout << "FuzzMatchers: " << iterations << " inputs passed\n";
+    return 0;
+}
+#endif
@@ -0,0 +1,132 @@
+// Binary genome cache: the cached sequence must equal a fresh FASTA parse
+// (N runs, soft-masking and CRLF included), any sub-range must decode to the
+// same bases, a changed FASTA must invalidate the cache, and a cache whose
+// header or tables point outside the file must be rejected.
+
+#include "../../include/FastaReader.hpp"
+#include "../../include/Genome.hpp"
+#include "../../include/GenomeCache.hpp"
+#include "TestUtils.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+    void writeFasta(const string& path, const vector<pair<string, string>>& records, bool crlf) {
+        ofstream out(path, ios::binary | ios::trunc);
+        const char* eol = crlf ? "\r\n" : "\n";
+        for (const auto& [name, seq] : records) {
+            out << '>' << name << eol;
+            for (size_t i = 0; i < seq.size(); i += 60) out << seq.substr(i, 60) << eol;
+        }
+    }
+
+    string readFile(const string& path) {
+        ifstream in(path, ios::binary);
+        return string(istreambuf_iterator<char>(in), istreambuf_iterator<char>());
+    }
+
+    void writeFile(const string& path, const string& bytes) {
+        ofstream out(path, ios::binary | ios::trunc);
+        out.write(bytes.data(), static_cast<streamsize>(bytes.size()));
+    }
+
+    void checkMatchesParse(const string& path, mt19937_64& rng, const string& label) {
+        const string parsed = FastaReader::parseSequence(path);
+        TestUtils::expectEqual(FastaReader::readSequence(path) == parsed, true, label + " readSequence");
+
+        auto cache = GenomeCache::open(path);
+        TestUtils::expectEqual(cache.has_value(), true, label + " cache opens");
+        if (!cache) return;
+        TestUtils::expectEqual(cache->size(), parsed.size(), label + " cache size");
+
+        string whole(parsed.size(), '?');
+        cache->decode(whole.data(), 0, whole.size());
+        TestUtils::expectEqual(whole == parsed, true, label + " full decode");
+
+        uniform_int_distribution<size_t> pos(0, parsed.size());
+        for (int i = 0; i < 200; ++i) {
+            size_t a = pos(rng), b = pos(rng);
+            if (a > b) swap(a, b);
+            string part(b - a, '?');
+            cache->decode(part.data(), a, b);
+            TestUtils::expectEqual(part == parsed.substr(a, b - a), true,
+                                   label + " decode [" + to_string(a) + ", " + to_string(b) + ")");
+        }
+
+        auto genome = Genome::load(path, 4);
+        TestUtils::expectEqual(genome->view() == string_view(parsed), true, label + " Genome::load from cache");
+    }
+
+} // namespace
+
+int main() {
+    mt19937_64 rng(36);
+    const string path = "build/GenomeCacheTest.fa";
+    remove(GenomeCache::cachePath(path).c_str());
+
+    string chr1 = TestUtils::randomText(rng, 300001, "ACGTacgt", 0.002);
+    string chr2 = TestUtils::randomText(rng, 77, "ACGT");
+    string chr3 = string(500, 'N') + TestUtils::randomText(rng, 1 << 20, "ACGT", 0.001) + string(3, 'n');
+    writeFasta(path, {{"chr1 first", chr1}, {"chr2", chr2}, {"chr3", chr3}}, true);
+
+    // First read parses and writes the cache
+    TestUtils::expectEqual(GenomeCache::open(path).has_value(), false, "no cache before first read");
+    checkMatchesParse(path, rng, "initial");
+
+    if (auto cache = GenomeCache::open(path)) {
+        auto records = cache->records();
+        TestUtils::expectEqual(records.size(), size_t{3}, "record count");
+        if (records.size() == 3) {
+            TestUtils::expectEqual(records[0].name, string("chr1 first"), "record 0 name");
+            TestUtils::expectEqual(records[0].length, uint64_t{chr1.size()}, "record 0 length");
+            TestUtils::expectEqual(records[1].offset, uint64_t{chr1.size()}, "record 1 offset");
+            TestUtils::expectEqual(records[2].length, uint64_t{chr3.size()}, "record 2 length");
+        }
+    }
+
+    // A rewritten FASTA (new size and mtime) must not be served from the old cache
+    string chr4 = TestUtils::randomText(rng, 4096, "ACGTN");
+    writeFasta(path, {{"chr1 first", chr1}, {"chr4", chr4}}, false);
+    TestUtils::expectEqual(GenomeCache::open(path).has_value(), false, "stale cache rejected");
+    checkMatchesParse(path, rng, "rewritten");
+
+    // Header and table fields that point outside the file or out of section order
+    const string cache_path = GenomeCache::cachePath(path);
+    const string pristine = readFile(cache_path);
+    uint64_t records_offset = 0, n_runs_offset = 0;
+    memcpy(&records_offset, pristine.data() + 72, sizeof(records_offset));
+    memcpy(&n_runs_offset, pristine.data() + 96, sizeof(n_runs_offset));
+    const vector<pair<string, pair<uint64_t, uint64_t>>> corruptions = {
+        {"record count past the file", {40, uint64_t{1} << 60}},
+        {"record count off by one", {40, 3}},
+        {"run count past the file", {48, uint64_t{1} << 59}},
+        {"records offset out of order", {72, 0}},
+        {"names offset past the file", {80, ~uint64_t{0} - 8}},
+        {"names length past the file", {88, uint64_t{1} << 62}},
+        {"runs offset out of order", {96, 128}},
+        {"record name past the names", {records_offset + 8, 1000}},
+        {"record span past the sequence", {records_offset + 24, uint64_t{1} << 40}},
+        {"N run past the sequence", {n_runs_offset, uint64_t{1} << 40}},
+    };
+    for (const auto& [label, patch] : corruptions) {
+        string bytes = pristine;
+        memcpy(bytes.data() + patch.first, &patch.second, sizeof(patch.second));
+        writeFile(cache_path, bytes);
+        TestUtils::expectEqual(GenomeCache::open(path).has_value(), false, "corrupt cache rejected: " + label);
+    }
+    writeFile(cache_path, pristine);
+    TestUtils::expectEqual(GenomeCache::open(path).has_value(), true, "restored cache opens");
+
+    remove(cache_path.c_str());
+    remove(path.c_str());
+    return TestUtils::finish("GenomeCacheTest");
+}
@@ -0,0 +1,101 @@
+// Incremental search: after any sequence of appends, substitutions, insertions
+// and deletions, the tracked positions must equal a naive scan of the edited
+// text, and a local edit must only rescan the chunks around it.
+
+#include "../../include/BM.hpp"
+#include "../../include/BNDM.hpp"
+#include "../../include/BP.hpp"
+#include "../../include/IncrementalSearch.hpp"
+#include "../../include/KMP.hpp"
+#include "../../include/QGramBMH.hpp"
+#include "TestUtils.hpp"
+
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+    unique_ptr<PatternMatcher> engine(int which) {
+        switch (which) {
+            case 0: return make_unique<KMP>();
+            case 1: return make_unique<BitParallelShiftOr>();
+            case 2: return make_unique<BoyerMooreHorspool>();
+            case 3: return make_unique<BNDM>();
+            default: return make_unique<QGramBMH>();
+        }
+    }
+
+    void expectTracks(const IncrementalSearch& inc, const string& label) {
+        const string text(inc.text());
+        auto expected = TestUtils::naivePositions(inc.pattern(), text);
+        TestUtils::expectEqual(inc.count(), expected.size(), label + " count");
+        TestUtils::expectEqual(inc.positions() == expected, true, label + " positions");
+    }
+
+    void randomEdits(int which, size_t m, mt19937_64& rng) {
+        // A small alphabet and short chunks make matches straddle chunk and edit boundaries
+        string text = TestUtils::randomText(rng, 20000, "AC");
+        string pattern = text.substr(777, m);
+        IncrementalSearch inc(pattern, text, engine(which), 3, 512);
+        const string label = "engine " + to_string(which) + " m=" + to_string(m);
+        expectTracks(inc, label + " initial");
+
+        for (int step = 0; step < 60; ++step) {
+            const size_t n = inc.size();
+            uniform_int_distribution<size_t> where(0, n);
+            const size_t pos = where(rng);
+            const size_t len = std::min<size_t>(rng() % 40, n - pos);
+            string bases = rng() % 4 == 0 ? pattern : TestUtils::randomText(rng, rng() % 60, "AC");
+            switch (step % 4) {
+                case 0: inc.append(bases); break;
+                case 1: inc.replace(pos, len, string(bases.begin(), bases.begin() + std::min(len, bases.size()))); break;
+                case 2: inc.replace(pos, 0, bases); break;
+                default: inc.replace(pos, len, ""); break;
+            }
+            expectTracks(inc, label + " step " + to_string(step));
+        }
+    }
+
+} // namespace
+
+int main() {
+    mt19937_64 rng(39);
+
+    for (int which = 0; which < 5; ++which)
+        for (size_t m : {1, 3, 9, 31, 64, 700})
+            if (which != 1 || m <= 64)  // shift-or handles patterns up to the word size
+                randomEdits(which, m, rng);
+
+    // A point edit in a large text rescans one or two chunks, not the text
+    string text = TestUtils::randomText(rng, 8 << 20, "ACGT");
+    const string pattern = text.substr(3 << 20, 20);
+    IncrementalSearch inc(pattern, text, nullptr, 4, IncrementalSearch::DEFAULT_CHUNK);
+    TestUtils::expectEqual(inc.lastRescanned(), text.size(), "initial scan covers the text");
+    inc.replace(5 << 20, 1, "G");
+    TestUtils::expectEqual(inc.lastRescanned() <= 2 * IncrementalSearch::DEFAULT_CHUNK, true, "point edit is local");
+    inc.append(pattern);
+    TestUtils::expectEqual(inc.lastRescanned() <= 2 * IncrementalSearch::DEFAULT_CHUNK, true, "append is local");
+    expectTracks(inc, "large text");
+
+    auto limited = inc.result(Query::firstN(2));
+    auto all = inc.positions();
+    TestUtils::expectEqual(limited.positions.size(), std::min<size_t>(2, all.size()), "limit result size");
+    TestUtils::expectEqual(inc.result().count, all.size(), "count result");
+
+    // Text that starts shorter than the pattern and grows into matches
+    IncrementalSearch growing("ACGTACGT", "ACG", nullptr, 2, 4);
+    TestUtils::expectEqual(growing.count(), size_t{0}, "short text has no match");
+    for (int i = 0; i < 10; ++i) growing.append("TACG");
+    expectTracks(growing, "grown text");
+    growing.replace(0, growing.size(), "");
+    TestUtils::expectEqual(growing.count(), size_t{0}, "emptied text");
+    TestUtils::expectEqual(growing.chunkCount(), size_t{0}, "emptied text has no chunks");
+    growing.append("ACGTACGTACGT");
+    expectTracks(growing, "refilled text");
+
+    return TestUtils::finish("IncrementalSearchTest");
+}
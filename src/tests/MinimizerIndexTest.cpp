@@ -0,0 +1,129 @@
+// Minimizer index: positions must equal a naive scan for every pattern the
+// index accepts, whatever the thread count used to build it, a saved index
+// must answer identically once mapped back in, and a damaged or inconsistent
+// file must be refused on load.
+
+#include "../../include/MinimizerIndex.hpp"
+#include "TestUtils.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+    void checkPatterns(const MinimizerIndex& index, const string& text, mt19937_64& rng, const string& label) {
+        const size_t lengths[] = {24, 25, 40, 100, 300, 1000, 5000};
+        uniform_int_distribution<size_t> where(0, text.size() - 1);
+        for (size_t m : lengths) {
+            for (int trial = 0; trial < 6; ++trial) {
+                string pattern;
+                if (trial < 4) {
+                    size_t start = where(rng) % (text.size() - m);
+                    pattern = text.substr(start, m);
+                } else {
+                    pattern = TestUtils::randomText(rng, m, "ACGT");
+                }
+                if (!index.canAnswer(pattern)) continue;
+                auto expected = TestUtils::naivePositions(pattern, text);
+                auto actual = index.find(pattern, text);
+                const string what = label + " m=" + to_string(m) + " trial=" + to_string(trial);
+                TestUtils::expectEqual(actual.size(), expected.size(), what + " count");
+                TestUtils::expectEqual(actual == expected, true, what + " positions");
+            }
+        }
+    }
+
+} // namespace
+
+int main() {
+    mt19937_64 rng(33);
+
+    // Tandem repeats make many identical seeds; N runs and soft-masking break k-mers
+    string text = TestUtils::randomText(rng, 1 << 20, "ACGT", 0.0005);
+    string unit = TestUtils::randomText(rng, 37, "ACGT");
+    for (size_t i = 0; i < 400; ++i) text.replace(200000 + i * unit.size(), unit.size(), unit);
+    for (size_t i = 600000; i < 620000; ++i) text[i] = static_cast<char>(text[i] | 0x20);
+
+    MinimizerIndex reference = MinimizerIndex::build(text, MinimizerIndex::DEFAULT_K, MinimizerIndex::DEFAULT_W, 1);
+    TestUtils::expectEqual(reference.matches(text), true, "index matches its own text");
+    checkPatterns(reference, text, rng, "1 thread");
+
+    // Inside the repeat array every occurrence must be reported
+    string repeat_pattern = text.substr(200000 + 5 * unit.size(), 300);
+    TestUtils::expectEqual(reference.count(repeat_pattern, text), TestUtils::naiveCount(repeat_pattern, text),
+                           "tandem repeat count");
+
+    for (int threads : {2, 3, 8}) {
+        MinimizerIndex parallel = MinimizerIndex::build(text, MinimizerIndex::DEFAULT_K, MinimizerIndex::DEFAULT_W, threads);
+        TestUtils::expectEqual(parallel.seedCount(), reference.seedCount(), "seeds with " + to_string(threads) + " threads");
+        checkPatterns(parallel, text, rng, to_string(threads) + " threads");
+    }
+
+    // Non-default parameters, and patterns the index must refuse
+    MinimizerIndex small = MinimizerIndex::build(text, 11, 5, 4);
+    checkPatterns(small, text, rng, "k=11 w=5");
+    TestUtils::expectEqual(reference.canAnswer(string(100, 'N')), false, "all-N pattern refused");
+    TestUtils::expectEqual(reference.canAnswer(text.substr(0, reference.minPatternLength() - 1)), false,
+                           "short pattern refused");
+
+    const string path = "build/MinimizerIndexTest.midx";
+    reference.save(path);
+    {
+        MinimizerIndex mapped = MinimizerIndex::load(path);
+        TestUtils::expectEqual(mapped.matches(text), true, "mapped index matches text");
+        TestUtils::expectEqual(mapped.seedCount(), reference.seedCount(), "mapped seed count");
+        checkPatterns(mapped, text, rng, "mapped");
+
+        // A same-length single-base edit anywhere must invalidate the index
+        for (size_t at : {size_t{0}, text.size() / 2 + 1, size_t{777777}, text.size() - 1}) {
+            string other = text;
+            other[at] = other[at] == 'A' ? 'C' : 'A';
+            TestUtils::expectEqual(mapped.matches(other), false, "index rejects a one-base edit at " + to_string(at));
+        }
+        string longer = text + "A";
+        TestUtils::expectEqual(mapped.matches(longer), false, "index rejects a longer text");
+    }
+
+    // One changed byte in the header, the table or the positions must fail the load
+    // Slots start after the 64-byte header; positions fill the end of the file
+    reference.save(path);
+    const size_t table_bytes = 64 + 8, positions_bytes = static_cast<size_t>(filesystem::file_size(path)) - 3;
+    const uint64_t huge_table = uint64_t{1} << 62;
+    struct Damage { string what; size_t offset; string bytes; };
+    const vector<Damage> damages = {
+        {"table byte", table_bytes, "\x5a"},
+        {"positions byte", positions_bytes, "\x5a"},
+        {"overflowing table size", 40, string(reinterpret_cast<const char*>(&huge_table), sizeof(huge_table))},
+    };
+    for (const Damage& d : damages) {
+        reference.save(path);
+        {
+            fstream f(path, ios::in | ios::out | ios::binary);
+            f.seekg(static_cast<streamoff>(d.offset));
+            string before(d.bytes.size(), '\0');
+            f.read(before.data(), static_cast<streamsize>(before.size()));
+            string after = d.bytes;
+            if (after == before) after[0] ^= 1;
+            f.seekp(static_cast<streamoff>(d.offset));
+            f.write(after.data(), static_cast<streamsize>(after.size()));
+        }
+        bool refused = false;
+        try {
+            MinimizerIndex::load(path);
+        } catch (const runtime_error&) {
+            refused = true;
+        }
+        TestUtils::expectEqual(refused, true, "load refuses a damaged " + d.what);
+    }
+    remove(path.c_str());
+
+    return TestUtils::finish("MinimizerIndexTest");
+}
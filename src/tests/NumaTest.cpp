@@ -0,0 +1,118 @@
+// NUMA placement: pinned workers must run on one CPU, the calling thread must
+// never be pinned (not even by a Local parallel search), and after a placement
+// benchmark (or an explicit restore) every OpenMP worker must be back on the
+// affinity mask it started with.
+
+#include "../../include/Benchmark.hpp"
+#include "../../include/Calibration.hpp"
+#include "../../include/GenomeCache.hpp"
+#include "../../include/KMP.hpp"
+#include "../../include/Numa.hpp"
+#include "TestUtils.hpp"
+
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+#include <omp.h>
+#include <pthread.h>
+#include <sched.h>
+
+using namespace std;
+
+namespace {
+
+    constexpr int THREADS = 4;
+
+    cpu_set_t currentMask() {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        pthread_getaffinity_np(pthread_self(), sizeof(set), &set);
+        return set;
+    }
+
+    // Mask of the main thread followed by the mask of each worker of a THREADS-wide team
+    vector<cpu_set_t> teamMasks() {
+        vector<cpu_set_t> masks(THREADS + 1);
+        masks[0] = currentMask();
+        #pragma omp parallel num_threads(THREADS)
+        {
+            masks[1 + omp_get_thread_num()] = currentMask();
+        }
+        return masks;
+    }
+
+    void expectMasks(const vector<cpu_set_t>& got, const vector<cpu_set_t>& want, const string& label) {
+        for (size_t i = 0; i < got.size(); ++i) {
+            const string who = i == 0 ? "main thread" : "worker " + to_string(i - 1);
+            TestUtils::expectEqual(static_cast<bool>(CPU_EQUAL(&got[i], &want[i])), true, label + ": " + who);
+        }
+    }
+
+} // namespace
+
+int main() {
+    omp_set_dynamic(0);
+    const vector<cpu_set_t> original = teamMasks();
+
+    // Pinning narrows every pooled worker to one CPU but leaves the caller's thread alone
+    Numa::setBinding(Numa::Binding::Local);
+    vector<int> pinned(THREADS, 0);
+    bool caller_untouched = false;
+    #pragma omp parallel num_threads(THREADS)
+    {
+        const int tid = omp_get_thread_num();
+        Numa::bindWorker(tid, THREADS);
+        cpu_set_t mask = currentMask();
+        pinned[tid] = CPU_COUNT(&mask);
+        if (tid == 0) caller_untouched = CPU_EQUAL(&mask, &original[0]);
+    }
+    TestUtils::expectEqual(caller_untouched, true, "local binding leaves the caller unpinned");
+    for (int tid = 1; tid < THREADS; ++tid)
+        TestUtils::expectEqual(pinned[tid], 1, "local binding pins worker " + to_string(tid));
+    expectMasks({currentMask()}, {original[0]}, "caller after a pinned region");
+
+    // A forced-Local parallel search must not leave the caller pinned either
+    Calibration::setCurrent({});
+    mt19937_64 search_rng(35);
+    const string text = TestUtils::randomText(search_rng, size_t{1} << 20, "ACGT");
+    const string pattern = text.substr(4242, 20);
+    KMP kmp;
+    TestUtils::expectEqual(kmp.searchParallel(pattern, text, THREADS), TestUtils::naiveCount(pattern, text),
+                           "forced-Local search count");
+    expectMasks({currentMask()}, {original[0]}, "caller after a forced-Local searchParallel");
+    Numa::setBinding(Numa::Binding::Off);
+    Numa::restoreAffinity();
+    expectMasks(teamMasks(), original, "after restoreAffinity");
+
+    // Off in a later region also unpins the workers it reaches
+    Numa::setBinding(Numa::Binding::Local);
+    #pragma omp parallel num_threads(THREADS)
+    {
+        Numa::bindWorker(omp_get_thread_num(), THREADS);
+    }
+    #pragma omp parallel num_threads(THREADS)
+    {
+        Numa::bindWorker(omp_get_thread_num(), THREADS, Numa::Binding::Off);
+    }
+    Numa::setBinding(Numa::Binding::Off);
+    expectMasks(teamMasks(), original, "after an Off region");
+
+    // The placement benchmark leaves neither the binding nor any affinity behind
+    const string path = "build/NumaTest.fa";
+    {
+        mt19937_64 rng(44);
+        const string seq = TestUtils::randomText(rng, size_t{1} << 20, "ACGT");
+        ofstream out(path, ios::binary | ios::trunc);
+        out << ">chr\n";
+        for (size_t i = 0; i < seq.size(); i += 60) out << seq.substr(i, 60) << '\n';
+    }
+    Benchmark::runPlacement("ACGTACGTACGT", path, THREADS);
+    TestUtils::expectEqual(Numa::binding() == Numa::Binding::Off, true, "binding restored");
+    expectMasks(teamMasks(), original, "after runPlacement");
+    remove(path.c_str());
+    remove(GenomeCache::cachePath(path).c_str());
+
+    return TestUtils::finish("NumaTest");
+}
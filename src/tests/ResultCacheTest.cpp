@@ -0,0 +1,155 @@
+// Result cache: a repeated query and its reverse complement must be served from
+// one entry with results equal to a fresh scan, every query mode keeps its own
+// entry, concurrent callers agree, eviction keeps both the entry count and the
+// bytes held under their bounds, and a rewritten reference is never answered
+// from stale entries.
+
+#include "../../include/BioUtils.hpp"
+#include "../../include/FastaReader.hpp"
+#include "../../include/GenomeCache.hpp"
+#include "../../include/HybridPicker.hpp"
+#include "TestUtils.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+    void writeFasta(const string& path, const string& seq) {
+        ofstream out(path, ios::binary | ios::trunc);
+        out << ">chr1\n";
+        for (size_t i = 0; i < seq.size(); i += 60) out << seq.substr(i, 60) << '\n';
+    }
+
+    vector<size_t> bothStrandPositions(const string& pattern, const string& text) {
+        auto hits = TestUtils::naivePositions(pattern, text);
+        const string rc = BioUtils::reverseComplement(pattern);
+        if (rc != pattern) {
+            auto rc_hits = TestUtils::naivePositions(rc, text);
+            hits.insert(hits.end(), rc_hits.begin(), rc_hits.end());
+            sort(hits.begin(), hits.end());
+        }
+        return hits;
+    }
+
+    void checkModes(HybridPicker& picker, const string& pattern, const string& path, const string& text,
+                    const string& label) {
+        const auto expected = TestUtils::naivePositions(pattern, text);
+        const auto both = bothStrandPositions(pattern, text);
+
+        auto counted = picker.searchCached(pattern, path);
+        TestUtils::expectEqual(counted.count, expected.size(), label + " count");
+        auto counted_both = picker.searchCached(pattern, path, Query::count(), true);
+        TestUtils::expectEqual(counted_both.count, both.size(), label + " count both strands");
+
+        auto exists = picker.searchCached(pattern, path, Query::exists());
+        TestUtils::expectEqual(exists.found(), !expected.empty(), label + " exists");
+
+        auto first = picker.searchCached(pattern, path, Query::first(), true);
+        TestUtils::expectEqual(first.found(), !both.empty(), label + " first both strands");
+        if (!both.empty() && first.found())
+            TestUtils::expectEqual(first.positions.front(), both.front(), label + " first position");
+
+        auto limited = picker.searchCached(pattern, path, Query::firstN(5));
+        vector<size_t> head(expected.begin(), expected.begin() + min<size_t>(5, expected.size()));
+        TestUtils::expectEqual(limited.positions == head, true, label + " first 5");
+    }
+
+} // namespace
+
+int main() {
+    mt19937_64 rng(38);
+    const string path = "build/ResultCacheTest.fa";
+    string text = TestUtils::randomText(rng, 1 << 20, "ACGT", 0.0005);
+
+    // Plant a primer on both strands
+    const string primer = "ACGTTGCATGCCAGT";
+    const string primer_rc = BioUtils::reverseComplement(primer);
+    for (size_t i = 0; i < 20; ++i) text.replace(1000 + i * 40000, primer.size(), i % 2 ? primer : primer_rc);
+    writeFasta(path, text);
+    text = FastaReader::readSequence(path);
+
+    HybridPicker picker;
+    ResultCache& cache = picker.resultCache();
+
+    TestUtils::expectEqual(ResultCache::canonical(primer), min(primer, primer_rc), "canonical pattern");
+    TestUtils::expectEqual(ResultCache::canonical(primer_rc), min(primer, primer_rc), "canonical of the flip");
+
+    auto forward = picker.searchCached(primer, path);
+    TestUtils::expectEqual(cache.misses(), size_t{1}, "first query misses");
+    TestUtils::expectEqual(forward.count, TestUtils::naiveCount(primer, text), "primer count");
+
+    // The same pattern and its reverse complement both hit the entry built above
+    auto again = picker.searchCached(primer, path);
+    auto flipped = picker.searchCached(primer_rc, path);
+    TestUtils::expectEqual(cache.hits(), size_t{2}, "repeat and flipped queries hit");
+    TestUtils::expectEqual(cache.size(), size_t{1}, "one entry for both strands");
+    TestUtils::expectEqual(again.count, forward.count, "repeat count");
+    TestUtils::expectEqual(flipped.count, TestUtils::naiveCount(primer_rc, text), "flipped count");
+
+    vector<string> patterns = {primer, primer_rc, "GAATTC", "ACGT", text.substr(500000, 40),
+                               TestUtils::randomText(rng, 30, "ACGT")};
+    for (const string& p : patterns) checkModes(picker, p, path, text, "pattern " + p);
+
+    // Parallel callers share the cache and must all see the scanned answer
+    int wrong = 0;
+    #pragma omp parallel for reduction(+ : wrong)
+    for (int i = 0; i < 64; ++i) {
+        const string& p = patterns[i % patterns.size()];
+        auto r = picker.searchCached(i % 3 ? p : BioUtils::reverseComplement(p), path);
+        const string& asked = i % 3 ? p : BioUtils::reverseComplement(p);
+        if (r.count != TestUtils::naiveCount(asked, text)) ++wrong;
+    }
+    TestUtils::expectEqual(wrong, 0, "concurrent callers");
+
+    // A bounded cache evicts the least recently used entry
+    ResultCache small(2);
+    ResultCache::ReferenceId ref{"ref", 1, 1};
+    for (const string& p : {string("AAA"), string("CCA"), string("GGA")}) small.insert(ref, p, Query::count(), {});
+    TestUtils::expectEqual(small.size(), size_t{2}, "capacity bound");
+    TestUtils::expectEqual(small.find(ref, "AAA", Query::count()).has_value(), false, "oldest evicted");
+    TestUtils::expectEqual(small.find(ref, "GGA", Query::count()).has_value(), true, "newest kept");
+
+    // Bytes held are bounded too: large position lists evict by size, and one that
+    // would take over a quarter of the budget is not kept at all
+    ResultCache sized(1024, 64 << 10);
+    ResultCache::StrandResults many;
+    many.canonical.positions.assign(1000, 7);
+    many.canonical.count = 1000;
+    for (int i = 0; i < 40; ++i) {
+        sized.insert(ref, to_string(i), Query::firstN(1000), many);
+        if (sized.bytes() > sized.byteCapacity()) break;
+    }
+    TestUtils::expectEqual(sized.bytes() <= sized.byteCapacity(), true, "byte bound");
+    TestUtils::expectEqual(sized.size() < 40, true, "evicted by size before the entry capacity");
+    TestUtils::expectEqual(sized.find(ref, "39", Query::firstN(1000)).has_value(), true, "newest sized entry kept");
+    TestUtils::expectEqual(sized.find(ref, "0", Query::firstN(1000)).has_value(), false, "oldest sized entry evicted");
+    ResultCache::StrandResults huge;
+    huge.flipped.positions.assign(4000, 9);
+    sized.insert(ref, "HUGE", Query::firstN(4000), huge);
+    TestUtils::expectEqual(sized.find(ref, "HUGE", Query::firstN(4000)).has_value(), false, "oversized result not kept");
+    sized.clear();
+    TestUtils::expectEqual(sized.bytes(), size_t{0}, "clear releases every byte");
+
+    // Rewriting the reference must invalidate its entries
+    string rewritten = text.substr(0, text.size() / 2) + primer + text.substr(text.size() / 2);
+    writeFasta(path, rewritten);
+    rewritten = FastaReader::readSequence(path);
+    const size_t misses = cache.misses();
+    auto after = picker.searchCached(primer, path);
+    TestUtils::expectEqual(cache.misses(), misses + 1, "rewritten reference misses");
+    TestUtils::expectEqual(after.count, TestUtils::naiveCount(primer, rewritten), "count after rewrite");
+
+    cache.invalidate(path);
+    TestUtils::expectEqual(cache.size(), size_t{0}, "invalidate drops entries");
+
+    remove(GenomeCache::cachePath(path).c_str());
+    remove(path.c_str());
+    return TestUtils::finish("ResultCacheTest");
+}
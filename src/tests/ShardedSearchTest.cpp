@@ -0,0 +1,149 @@
+// Sharded search: worker processes that each hold one shard must together
+// report exactly what a naive scan of the whole reference reports, including
+// matches that straddle a shard boundary, whether they decode it from the
+// binary cache (written before the fork when missing) or, when no cache can be
+// written, copy it from the coordinator's parse; a traced coordinator must get
+// the same answers, and once a worker dies the instance must refuse every
+// further query.
+
+#include "../../include/FastaReader.hpp"
+#include "../../include/GenomeCache.hpp"
+#include "../../include/ShardedSearch.hpp"
+#include "../../include/Trace.hpp"
+#include "TestUtils.hpp"
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace std;
+
+namespace {
+
+    void writeFasta(const string& path, const vector<pair<string, string>>& records) {
+        ofstream out(path, ios::binary | ios::trunc);
+        for (const auto& [name, seq] : records) {
+            out << '>' << name << '\n';
+            for (size_t i = 0; i < seq.size(); i += 70) out << seq.substr(i, 70) << '\n';
+        }
+    }
+
+    // Live children of this process, oldest first
+    vector<pid_t> childPids() {
+        ifstream in("/proc/self/task/" + to_string(getpid()) + "/children");
+        vector<pid_t> pids;
+        for (pid_t pid; in >> pid;) pids.push_back(pid);
+        return pids;
+    }
+
+    void checkShards(const string& path, const string& text, int shard_count, const vector<string>& patterns,
+                     const string& label) {
+        ShardedSearch sharded(path, shard_count, 64);
+        TestUtils::expectEqual(sharded.size(), text.size(), label + " size");
+        for (const string& p : patterns) {
+            const auto expected = TestUtils::naivePositions(p, text);
+            const string what = label + " pattern " + p;
+            TestUtils::expectEqual(sharded.count(p), expected.size(), what + " count");
+            TestUtils::expectEqual(sharded.query(p, Query::exists()).found(), !expected.empty(), what + " exists");
+
+            auto limited = sharded.query(p, Query::firstN(7));
+            vector<size_t> head(expected.begin(), expected.begin() + min<size_t>(7, expected.size()));
+            TestUtils::expectEqual(limited.positions == head, true, what + " first 7");
+
+            auto all = sharded.query(p, Query::firstN(expected.size() + 1));
+            TestUtils::expectEqual(all.positions == expected, true, what + " all positions");
+        }
+    }
+
+} // namespace
+
+int main() {
+    mt19937_64 rng(40);
+    const string path = "build/ShardedSearchTest.fa";
+    remove(GenomeCache::cachePath(path).c_str());
+
+    string chr1 = TestUtils::randomText(rng, 200003, "ACGT", 0.001);
+    string chr2 = TestUtils::randomText(rng, 99991, "ACGTacgt");
+    writeFasta(path, {{"chr1", chr1}, {"chr2", chr2}});
+
+    // Streaming range reads (no cache yet) must agree with a full parse
+    const string text = FastaReader::parseSequence(path);
+    TestUtils::expectEqual(FastaReader::sequenceLength(path), text.size(), "streamed length");
+    for (auto [a, b] : vector<pair<size_t, size_t>>{{0, 10}, {69, 71}, {199990, 200020}, {text.size() - 5, text.size() + 5}})
+        TestUtils::expectEqual(FastaReader::readRange(path, a, b) == text.substr(a, b - a), true,
+                               "streamed range [" + to_string(a) + ", " + to_string(b) + ")");
+
+    // Patterns planted right across every boundary of the 2-, 3- and 7-way layouts
+    vector<string> patterns = {"ACGTACGTAC", "GATTACA", "A", text.substr(12345, 64)};
+    for (int shards : {2, 3, 7}) {
+        size_t chunk = (text.size() + shards - 1) / shards;
+        for (int s = 1; s < shards; ++s) patterns.push_back(text.substr(s * chunk - 5, 20));
+    }
+
+    // A directory in the cache's place makes the write fail: workers copy from the parse
+    const string cache_path = GenomeCache::cachePath(path);
+    filesystem::create_directory(cache_path);
+    checkShards(path, text, 1, patterns, "1 shard, uncached");
+    checkShards(path, text, 3, patterns, "3 shards, uncached");
+    filesystem::remove(cache_path);
+
+    // Without a cache the coordinator writes one before forking
+    checkShards(path, text, 3, patterns, "3 shards, cache written");
+    TestUtils::expectEqual(GenomeCache::open(path).has_value(), true, "cache written before the fork");
+    TestUtils::expectEqual(FastaReader::readRange(path, 150000, 250000) == text.substr(150000, 100000), true,
+                           "cached range");
+    for (int shards : {2, 7}) checkShards(path, text, shards, patterns, to_string(shards) + " shards, cached");
+
+    // Forking while the coordinator traces: workers switch tracing off, answers are unchanged
+    Trace::clear();
+    Trace::enable();
+    checkShards(path, text, 2, {"GATTACA"}, "2 shards, traced");
+    Trace::disable();
+    TestUtils::expectEqual(Trace::eventCount() > 0, true, "coordinator spans recorded");
+    Trace::clear();
+
+    // Over-long patterns are refused, and more shards than bases still answers
+    checkShards(path, text, 2, {"NNNN"}, "N run");
+    bool threw = false;
+    try {
+        ShardedSearch sharded(path, 2, 64);
+        sharded.count(string(65, 'A'));
+    } catch (const invalid_argument&) {
+        threw = true;
+    }
+    TestUtils::expectEqual(threw, true, "pattern longer than the overlap is refused");
+
+    // A killed worker fails the query, and every later query, instead of reading stale replies
+    {
+        ShardedSearch sharded(path, 3, 64);
+        const vector<pid_t> children = childPids();
+        TestUtils::expectEqual(children.size(), size_t{3}, "one child per shard");
+        if (!children.empty()) {
+            kill(children.back(), SIGKILL);
+            siginfo_t info;
+            waitid(P_PID, static_cast<id_t>(children.back()), &info, WEXITED | WNOWAIT);
+        }
+        string first, second;
+        try { sharded.count(patterns[0]); } catch (const runtime_error& e) { first = e.what(); }
+        try { sharded.count(patterns[1]); } catch (const runtime_error& e) { second = e.what(); }
+        TestUtils::expectEqual(first.find("is gone") != string::npos, true, "dead worker fails the query");
+        TestUtils::expectEqual(second.find("died earlier") != string::npos, true, "instance stays broken");
+    }
+
+    const string tiny = "build/ShardedSearchTiny.fa";
+    writeFasta(tiny, {{"t", "ACGTA"}});
+    checkShards(tiny, "ACGTA", 8, {"A", "GTA", "ACGTAC"}, "8 shards over 5 bases");
+
+    remove(GenomeCache::cachePath(tiny).c_str());
+    remove(tiny.c_str());
+    remove(GenomeCache::cachePath(path).c_str());
+    remove(path.c_str());
+    return TestUtils::finish("ShardedSearchTest");
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Minimal assertion helpers shared by the test programs (no framework dependency)
+namespace TestUtils {
+
+    inline int& failures() {
+        static int count = 0;
+        return count;
+    }
+
+    template <typename A, typename B>
+    void expectEqual(const A& actual, const B& expected, const std::string& what) {
+        if (actual != expected) {
+            ++failures();
+            std::cerr << "FAIL: " << what << ": got " << actual << ", expected " << expected << "\n";
+        }
+    }
+
+    inline int finish(const std::string& suite) {
+        if (failures() == 0) {
+            std::cout << suite << ": all checks passed\n";
+            return 0;
+        }
+        std::cerr << suite << ": " << failures() << " check(s) failed\n";
+        return 1;
+    }
+
+    // Reference count: every alignment compared byte by byte
+    inline size_t naiveCount(std::string_view pattern, std::string_view text) {
+        const size_t n = text.size(), m = pattern.size();
+        if (m == 0 || n < m) return 0;
+        size_t count = 0;
+        for (size_t s = 0; s + m <= n; ++s)
+            if (text.compare(s, m, pattern) == 0) ++count;
+        return count;
+    }
+
+    // Reference positions, ascending
+    inline std::vector<size_t> naivePositions(std::string_view pattern, std::string_view text) {
+        std::vector<size_t> hits;
+        const size_t n = text.size(), m = pattern.size();
+        if (m == 0 || n < m) return hits;
+        for (size_t s = 0; s + m <= n; ++s)
+            if (text.compare(s, m, pattern) == 0) hits.push_back(s);
+        return hits;
+    }
+
+    // Random text over `alphabet`, optionally sprinkled with runs of N
+    inline std::string randomText(std::mt19937_64& rng, size_t n, std::string_view alphabet, double n_run_rate = 0.0) {
+        std::string text(n, 'A');
+        std::uniform_int_distribution<size_t> pick(0, alphabet.size() - 1);
+        std::uniform_real_distribution<double> coin(0.0, 1.0);
+        std::uniform_int_distribution<size_t> run(1, 200);
+        for (size_t i = 0; i < n; ++i) {
+            if (n_run_rate > 0.0 && coin(rng) < n_run_rate) {
+                size_t len = std::min(run(rng), n - i);
+                for (size_t k = 0; k < len; ++k) text[i + k] = 'N';
+                i += len - 1;
+            } else {
+                text[i] = alphabet[pick(rng)];
+            }
+        }
+        return text;
+    }
+}
@@ -0,0 +1,83 @@
+// Tracing: spans are recorded only while enabled, every parallel worker gets
+// its own track, the dump is Chrome trace-event JSON, and clear() may run
+// while other threads are recording.
+
+#include "../../include/Calibration.hpp"
+#include "../../include/QGramBMH.hpp"
+#include "../../include/Trace.hpp"
+#include "TestUtils.hpp"
+
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <set>
+#include <sstream>
+#include <string>
+#include <omp.h>
+
+using namespace std;
+
+int main() {
+    mt19937_64 rng(37);
+    const string text = TestUtils::randomText(rng, size_t{4} << 20, "ACGT");
+    const string pattern = text.substr(123456, 40);
+    QGramBMH qbmh;
+    // Worker count must not depend on a calibration file present on the host
+    Calibration::setCurrent({});
+
+    // Disabled: nothing is recorded
+    Trace::clear();
+    qbmh.searchParallel(pattern, text, 4);
+    TestUtils::expectEqual(Trace::eventCount(), size_t{0}, "no events while disabled");
+
+    Trace::enable();
+    const size_t matches = qbmh.searchParallel(pattern, text, 4);
+    Trace::disable();
+    TestUtils::expectEqual(matches, TestUtils::naiveCount(pattern, text), "traced search count");
+    // search_parallel + shift_table + one scan_chunk per worker
+    TestUtils::expectEqual(Trace::eventCount() >= 6, true, "events recorded while enabled");
+
+    const string path = "build/TraceTest.json";
+    TestUtils::expectEqual(Trace::writeChromeJson(path), true, "trace written");
+    ifstream in(path);
+    stringstream json;
+    json << in.rdbuf();
+    const string body = json.str();
+
+    TestUtils::expectEqual(body.rfind("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[", 0), size_t{0}, "trace-event envelope");
+    TestUtils::expectEqual(body.find("\"name\":\"qbmh.shift_table\"") != string::npos, true, "table build span");
+    TestUtils::expectEqual(body.find("\"name\":\"qbmh.search_parallel\"") != string::npos, true, "search span");
+
+    // Each scan_chunk line carries its worker's tid
+    set<string> tids;
+    istringstream lines(body);
+    for (string line; getline(lines, line);) {
+        if (line.find("qbmh.scan_chunk") == string::npos) continue;
+        size_t at = line.find("\"tid\":");
+        tids.insert(line.substr(at, line.find('}', at) - at));
+    }
+    TestUtils::expectEqual(tids.size(), size_t{4}, "one scan_chunk track per worker");
+
+    remove(path.c_str());
+
+    // Workers keep recording while thread 0 clears; once they stop, a clear drops everything
+    Trace::enable();
+    atomic<bool> stop{false};
+    #pragma omp parallel num_threads(4)
+    {
+        if (omp_get_thread_num() == 0) {
+            for (int i = 0; i < 2000; ++i) Trace::clear();
+            stop.store(true);
+        } else {
+            while (!stop.load()) {
+                TRACE_SCOPE("trace_test.busy");
+            }
+        }
+    }
+    Trace::disable();
+    Trace::clear();
+    TestUtils::expectEqual(Trace::eventCount(), size_t{0}, "clear after concurrent recording");
+
+    return TestUtils::finish("TraceTest");
+}
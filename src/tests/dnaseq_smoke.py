@@ -0,0 +1,178 @@
+# Python module smoke test: every engine must give the naive count through
+# every zero-copy sequence view (str, bytes, bytearray, memoryview, uint8 numpy
+# array, Genome), views the module cannot borrow must be rejected instead of
+# copied, query modes must return the naive positions, and search_cached must
+# agree with a fresh scan of the FASTA it was given.
+#
+# Run with: make python-test
+
+import os
+import random
+import sys
+import tempfile
+
+import numpy as np
+
+import dnaseq
+
+failures = 0
+
+
+def expect_equal(got, want, what):
+    global failures
+    if got != want:
+        failures += 1
+        print(f"FAIL {what}: got {got!r}, want {want!r}")
+
+
+def expect_raises(error, fn, what):
+    global failures
+    try:
+        fn()
+    except error:
+        return
+    except Exception as e:
+        failures += 1
+        print(f"FAIL {what}: raised {type(e).__name__}, want {error.__name__}")
+        return
+    failures += 1
+    print(f"FAIL {what}: nothing raised, want {error.__name__}")
+
+
+def naive_positions(pattern, text):
+    hits, at = [], text.find(pattern)
+    while at != -1:
+        hits.append(at)
+        at = text.find(pattern, at + 1)
+    return hits
+
+
+def reverse_complement(s):
+    return s.translate(str.maketrans("ACGT", "TGCA"))[::-1]
+
+
+ENGINES = [dnaseq.BoyerMooreHorspool, dnaseq.KMP, dnaseq.BitParallelShiftOr, dnaseq.BNDM, dnaseq.QGramBMH]
+
+
+def check_views(text, pattern):
+    want = len(naive_positions(pattern, text))
+    raw = text.encode()
+    genome = dnaseq.Genome(text, "smoke")
+    views = {
+        "str": text,
+        "bytes": raw,
+        "bytearray": bytearray(raw),
+        "memoryview": memoryview(raw),
+        "numpy": np.frombuffer(raw, dtype=np.uint8),
+        "Genome": genome,
+    }
+    compiled = dnaseq.compile(pattern)
+    for cls in ENGINES:
+        engine = cls()
+        for label, view in views.items():
+            what = f"{engine.name} {label}"
+            expect_equal(engine.search(pattern, view), want, what + " search")
+            expect_equal(engine.search(compiled, view), want, what + " compiled search")
+            expect_equal(engine.search_parallel(pattern, view, 4), want, what + " search_parallel")
+
+    # The Genome hands out its own bases: two numpy views share one buffer
+    expect_equal(len(genome), len(text), "Genome length")
+    shared = np.frombuffer(genome, dtype=np.uint8)
+    expect_equal(bool(np.shares_memory(shared, np.frombuffer(genome, dtype=np.uint8))), True, "Genome views share memory")
+    expect_equal(shared.tobytes(), raw, "Genome buffer contents")
+    expect_equal(memoryview(genome).readonly, True, "Genome buffer is read-only")
+
+    # Buffers that cannot be borrowed as one run of bytes are refused, not copied
+    kmp = dnaseq.KMP()
+    strided = np.frombuffer(raw, dtype=np.uint8)[::2]
+    expect_raises(ValueError, lambda: kmp.search(pattern, strided), "strided numpy array")
+    expect_raises(ValueError, lambda: kmp.search(pattern, np.frombuffer(raw, dtype=np.uint8).reshape(2, -1)),
+                  "2-d numpy array")
+    expect_raises(ValueError, lambda: kmp.search(pattern, np.zeros(8, dtype=np.uint16)), "wide numpy dtype")
+    expect_raises(TypeError, lambda: kmp.search(pattern, 12345), "non-sequence text")
+
+    # A bytearray is read in place, so edits are seen by the next search
+    edited = bytearray(raw)
+    edited[:len(pattern)] = pattern.encode()
+    expect_equal(kmp.search(pattern, edited), len(naive_positions(pattern, edited.decode())), "edited bytearray")
+
+
+def check_queries(text, pattern):
+    hits = naive_positions(pattern, text)
+    compiled = dnaseq.compile(pattern)
+    for cls in ENGINES:
+        engine = cls()
+        for threads in (1, 4):
+            what = f"{engine.name} query x{threads}"
+            for p in (pattern, compiled):
+                counted = engine.query(p, text, dnaseq.Query.count(), threads)
+                expect_equal(counted.count, len(hits), what + " count")
+                expect_equal(counted.positions, [], what + " count has no positions")
+
+                exists = engine.query(p, text, dnaseq.Query.exists(), threads)
+                expect_equal(exists.found(), bool(hits), what + " exists")
+                expect_equal(all(pos in hits for pos in exists.positions), True, what + " exists position is a hit")
+
+                expect_equal(engine.query(p, text, dnaseq.Query.first(), threads).positions, hits[:1], what + " first")
+                limited = engine.query(p, text, dnaseq.Query.first_n(3), threads)
+                expect_equal(limited.positions, hits[:3], what + " first 3")
+                expect_equal(limited.count, min(3, len(hits)), what + " first 3 count")
+
+    q = dnaseq.Query()
+    q.mode, q.limit = dnaseq.QueryMode.Limit, 2
+    expect_equal(dnaseq.KMP().query(pattern, text, q).positions, hits[:2], "hand-built Limit query")
+
+
+def check_cached(text, pattern, directory):
+    path = os.path.join(directory, "smoke.fa")
+    with open(path, "w") as out:
+        out.write(">chr1\n")
+        for i in range(0, len(text), 60):
+            out.write(text[i:i + 60] + "\n")
+
+    hits = naive_positions(pattern, text)
+    rc = reverse_complement(pattern)
+    both = sorted(hits + (naive_positions(rc, text) if rc != pattern else []))
+
+    picker = dnaseq.HybridPicker()
+    for attempt in ("miss", "hit"):
+        what = f"search_cached {attempt}"
+        expect_equal(picker.search_cached(pattern, path).count, len(hits), what + " count")
+        expect_equal(picker.search_cached(pattern, path, dnaseq.Query.count(), True).count, len(both),
+                     what + " count both strands")
+        expect_equal(picker.search_cached(pattern, path, dnaseq.Query.first_n(5)).positions, hits[:5],
+                     what + " first 5")
+        expect_equal(picker.search_cached(rc, path, dnaseq.Query.first(), True).positions, both[:1],
+                     what + " reverse complement first")
+        expect_equal(picker.search_cached(pattern, path, query=dnaseq.Query.exists()).found(), bool(hits),
+                     what + " exists")
+
+    genome = dnaseq.Genome.load(path)
+    expect_equal(len(genome), len(text), "Genome.load length")
+    expect_equal(dnaseq.BNDM().search(pattern, genome), len(hits), "Genome.load search")
+
+
+def main():
+    rng = random.Random(44)
+    text = "".join(rng.choices("ACGT", k=(1 << 20) + 4099))
+    # Planted on both strands so every mode has several hits
+    pattern = "ACGTTGCATGCCAGTA"
+    for i, at in enumerate(range(1000, len(text) - 100, 50021)):
+        planted = pattern if i % 2 else reverse_complement(pattern)
+        text = text[:at] + planted + text[at + len(planted):]
+
+    check_views(text, pattern)
+    check_views(text, "ACG")
+    check_queries(text, pattern)
+    with tempfile.TemporaryDirectory() as directory:
+        check_cached(text, pattern, directory)
+
+    if failures:
+        print(f"dnaseq_smoke: {failures} check(s) failed")
+        return 1
+    print("dnaseq_smoke: all checks passed")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())